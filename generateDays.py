@@ -2,6 +2,9 @@ import os
 
 year = "2025"
 
+# contain no solutions and have to follow the utils library, so they are rewritten in existing days as well
+regenerated = {"CMakeLists.txt"}
+
 class Template:
     name: str = None
     content: str = None
@@ -40,12 +43,17 @@ def create_day(day: int) -> bool:
     updated = False
     for template in templates:
         file_path = f"{dir_path}/{template.name}"
+        content = template.get_replaced(day)
         if os.path.isfile(file_path):
-            continue
+            if template.name not in regenerated:
+                continue
+            with open(file_path) as file:
+                if file.read() == content:
+                    continue
 
         updated = True
-        with open(file_path, "x") as file:
-            file.write(template.get_replaced(day))
+        with open(file_path, "w") as file:
+            file.write(content)
 
     if created:
         num_created += 1
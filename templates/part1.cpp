@@ -1,36 +1,41 @@
 #include <utils.h>
 
-int solve(const std::string &input) {
+int solve(std::string_view input) {
 	int result = 0;
+	std::vector<int> numbers;
 
-    std::regex pattern("(\\d+)");
-
-	auto blocks = split(input, "\n\n");
+	auto blocks = split_view(input, "\n\n");
 	for (const auto& block : blocks) {
-		auto lines = split(block, "\n");
+		auto lines = split_view(block, "\n");
 		auto lines2 = split_int(block, "\n");
-        const auto [a] = extract_data<int>(block, std::regex("(\\d+)"));
+		auto block_numbers = extract_ints(block);
 
-		for (const auto& line : lines) {
+		for (auto line : lines) {
 
 		}
 	}
 
-	auto lines = split(input, "\n");
+	auto parse_phase = ScopedPhase("parse");
+	auto lines = split_view(input, "\n", run_memory());
 	auto lines2 = split_int(input, "\n");
+	parse_phase.stop();
 
-    for (const auto& line : lines) {
-    	const auto [a] = extract_data<int>(line, std::regex("(\\d+)"));
+	PHASE("solve");
+    for (auto line : lines) {
+		numbers.clear();
+		extract_ints(line, numbers);
     }
 
 	return result;
 }
 
 int main(int argc, char** argv) {
-    auto runner = Runner<int>(solve, REPLACE_YEAR, REPLACE_DAY_NUM);
+    auto runner = Runner<int>(solve, REPLACE_YEAR, REPLACE_DAY_NUM, 1);
+    runner.parse_args(argc, argv);
     runner.add_test_file("t1.txt", 0);
 
     runner.add_input_file("i1.txt");
 
     runner.run();
+    return runner.exit_code();
 }
\ No newline at end of file
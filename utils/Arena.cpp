@@ -0,0 +1,76 @@
+#include "Arena.h"
+
+#include "utils.h"
+
+void* RunArena::Upstream::do_allocate(size_t bytes, size_t alignment) {
+	reserved += bytes;
+	return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+}
+
+void RunArena::Upstream::do_deallocate(void* p, size_t bytes, size_t alignment) {
+	std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+}
+
+// first block of the next arena on this thread; taken while an arena is alive, so nested arenas get their own
+static thread_local ArenaBlock retained_buffer{};
+
+/**
+ * Uninitialized block whose pages are already touched once, so the next run does not fault them in
+ */
+static ArenaBlock allocate_block(size_t size) {
+	ArenaBlock block{std::make_unique_for_overwrite<std::byte[]>(size), size};
+	for (size_t i = 0; i < size; i += 4096) {
+		block.data[i] = std::byte{0};
+	}
+	return block;
+}
+
+static ArenaBlock take_buffer(size_t initial_size) {
+	auto buffer = std::exchange(retained_buffer, {});
+	if (buffer.size < initial_size) {
+		buffer = allocate_block(initial_size);
+	}
+	return buffer;
+}
+
+RunArena::RunArena(size_t initial_size)
+	: buffer(take_buffer(initial_size)), arena(buffer.data.get(), buffer.size, &upstream) {}
+
+RunArena::~RunArena() {
+	arena.release();
+	if (upstream.reserved > 0 && buffer.size < MAX_RETAINED_ARENA) {
+		// one block big enough for everything this run needed
+		buffer = allocate_block(std::min(buffer.size + upstream.reserved, MAX_RETAINED_ARENA));
+	}
+	if (buffer.size > retained_buffer.size) {
+		retained_buffer = std::move(buffer);
+	}
+}
+
+void release_retained_arena() {
+	retained_buffer = {};
+}
+
+ArenaStats RunArena::stats() const {
+	auto result = counters;
+	result.reserved = buffer.size + upstream.reserved;
+	return result;
+}
+
+void* RunArena::do_allocate(size_t bytes, size_t alignment) {
+	++counters.allocations;
+	counters.bytes += bytes;
+	live += bytes;
+	counters.peak = std::max(counters.peak, live);
+	return arena.allocate(bytes, alignment);
+}
+
+void RunArena::do_deallocate(void* p, size_t bytes, size_t alignment) {
+	live -= bytes;
+	arena.deallocate(p, bytes, alignment);
+}
+
+std::string format_arena_stats(const ArenaStats& stats) {
+	return fmt::format("{} allocation(s), {} requested, peak {} live, {} reserved",
+		stats.allocations, format_bytes(stats.bytes), format_bytes(stats.peak), format_bytes(stats.reserved));
+}
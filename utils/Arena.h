@@ -0,0 +1,129 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+/* ====================================================================================================
+ * Per-Run Arena
+ */
+
+struct ArenaStats {
+	size_t allocations = 0;
+	/** sum of all requested bytes */
+	size_t bytes = 0;
+	/** most requested bytes that were not yet deallocated at the same time */
+	size_t peak = 0;
+	/** size of the retained first block plus the blocks the arena took from the heap */
+	size_t reserved = 0;
+};
+
+/**
+ * Upper bound for the first block that a thread keeps between arenas
+ */
+constexpr size_t MAX_RETAINED_ARENA = size_t(64) << 20;
+
+/**
+ * Uninitialized heap block of a RunArena
+ */
+struct ArenaBlock {
+	std::unique_ptr<std::byte[]> data = nullptr;
+	size_t size = 0;
+};
+
+/**
+ * Monotonic arena for the allocations of one solver call: allocating bumps a pointer, deallocating
+ * does nothing and everything is released at once when the arena is destroyed.
+ * The first block is a per-thread buffer that is kept between arenas and grows to what the previous
+ * arena needed in total (up to MAX_RETAINED_ARENA), so repeated runs (benchmark mode) work in already
+ * touched memory. Growing it happens in the destructor, so construct and destroy arenas outside of
+ * timed sections. Counts the requests so the Runner can report them.
+ */
+class RunArena final : public std::pmr::memory_resource {
+private:
+	/** heap resource that remembers how much the arena took */
+	class Upstream final : public std::pmr::memory_resource {
+	public:
+		size_t reserved = 0;
+
+	protected:
+		void* do_allocate(size_t bytes, size_t alignment) override;
+		void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+		bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+	};
+
+	Upstream upstream{};
+	ArenaBlock buffer;
+	std::pmr::monotonic_buffer_resource arena;
+	ArenaStats counters{};
+	size_t live = 0;
+
+public:
+	/**
+	 * @param initial_size minimum size of the first block
+	 */
+	explicit RunArena(size_t initial_size = 64 * 1024);
+
+	RunArena(const RunArena&) = delete;
+	RunArena& operator=(const RunArena&) = delete;
+
+	~RunArena() override;
+
+	ArenaStats stats() const;
+
+protected:
+	void* do_allocate(size_t bytes, size_t alignment) override;
+	void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+	bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+};
+
+/**
+ * Frees the first block this thread keeps for its next RunArena (the Runner calls it after the last input).
+ * Pool threads free theirs when they exit.
+ */
+void release_retained_arena();
+
+/**
+ * Arena of the currently running solver call. nullptr outside of one (or with --no-arena).
+ */
+inline thread_local RunArena* active_arena = nullptr;
+
+/**
+ * Memory resource for allocations that only live as long as the running solver call:
+ * its arena if there is one, otherwise the default (heap) resource
+ *   std::pmr::vector<Vec2i> points(run_memory());
+ *   auto lines = split_view(input, "\n", run_memory());
+ */
+inline std::pmr::memory_resource* run_memory() {
+	return active_arena != nullptr ? static_cast<std::pmr::memory_resource*>(active_arena) : std::pmr::get_default_resource();
+}
+
+/**
+ * Makes the arena the active_arena of this thread until the end of the scope
+ */
+class ScopedArena {
+private:
+	RunArena* previous;
+
+public:
+	explicit ScopedArena(RunArena* arena) : previous(active_arena) {
+		active_arena = arena;
+	}
+
+	ScopedArena(const ScopedArena&) = delete;
+	ScopedArena& operator=(const ScopedArena&) = delete;
+
+	~ScopedArena() {
+		active_arena = previous;
+	}
+};
+
+/**
+ * Formats the stats as "N allocation(s), X requested, peak Y live, Z reserved"
+ */
+std::string format_arena_stats(const ArenaStats& stats);
+
+#endif //ARENA_H
@@ -0,0 +1,243 @@
+#include "BitGrid.h"
+
+#include <Logger.h>
+
+#include <algorithm>
+#include <bit>
+#include <cstdlib>
+#include <ostream>
+
+BitGrid::BitGrid(int width, int height, bool value)
+	: w(width), h(height), row_words((width + 63) / 64),
+	  words(static_cast<size_t>(row_words) * height, value ? ~uint64_t{0} : 0) {
+	clear_padding_bits();
+}
+
+BitGrid BitGrid::from_view(const GridView<const char>& view, char on) {
+	auto grid = BitGrid(view.width(), view.height());
+	for (int y = 0; y < grid.h; ++y) {
+		auto row = grid.row(y);
+		for (int x = 0; x < grid.w; ++x) {
+			row[x >> 6] |= static_cast<uint64_t>(view(x, y) == on) << (x & 63);
+		}
+	}
+	return grid;
+}
+
+BitGrid BitGrid::parse(std::string_view input, char on) {
+	return from_view(grid_view(input), on);
+}
+
+void BitGrid::fill(bool value) {
+	std::fill(words.begin(), words.end(), value ? ~uint64_t{0} : 0);
+	clear_padding_bits();
+}
+
+size_t BitGrid::count() const {
+	size_t count = 0;
+	for (const uint64_t word : words) {
+		count += std::popcount(word);
+	}
+	return count;
+}
+
+bool BitGrid::any() const {
+	return std::any_of(words.begin(), words.end(), [](uint64_t word) { return word != 0; });
+}
+
+std::vector<Vec2i> BitGrid::positions() const {
+	std::vector<Vec2i> positions(count());
+	size_t n = 0;
+	for (int y = 0; y < h; ++y) {
+		const auto row = this->row(y);
+		for (int i = 0; i < row_words; ++i) {
+			for (uint64_t word = row[i]; word != 0; word &= word - 1) {
+				positions[n++] = Vec2i{i * 64 + std::countr_zero(word), y};
+			}
+		}
+	}
+	return positions;
+}
+
+BitGrid BitGrid::shifted(int dx, int dy) const {
+	auto result = BitGrid(w, h);
+	if (std::abs(dx) >= w || std::abs(dy) >= h) {
+		return result;
+	}
+
+	const int word_shift = std::abs(dx) / 64;
+	const int bit_shift = std::abs(dx) % 64;
+
+	for (int y = std::max(0, dy); y < std::min(h, h + dy); ++y) {
+		const auto src = row(y - dy);
+		auto dst = result.row(y);
+
+		if (dx >= 0) {
+			// towards higher x: bits move to higher positions and carry into the next word
+			for (int i = row_words - 1; i >= word_shift; --i) {
+				uint64_t word = src[i - word_shift] << bit_shift;
+				if (bit_shift != 0 && i - word_shift - 1 >= 0) {
+					word |= src[i - word_shift - 1] >> (64 - bit_shift);
+				}
+				dst[i] = word;
+			}
+		} else {
+			for (int i = 0; i + word_shift < row_words; ++i) {
+				uint64_t word = src[i + word_shift] >> bit_shift;
+				if (bit_shift != 0 && i + word_shift + 1 < row_words) {
+					word |= src[i + word_shift + 1] << (64 - bit_shift);
+				}
+				dst[i] = word;
+			}
+		}
+	}
+
+	result.clear_padding_bits();
+	return result;
+}
+
+BitGrid BitGrid::neighbours(const std::vector<Vec2i>& dirs) const {
+	auto result = BitGrid(w, h);
+	for (const auto& dir : dirs) {
+		result |= shifted(dir);
+	}
+	return result;
+}
+
+BitGrid::NeighbourCount BitGrid::count_neighbours(const std::vector<Vec2i>& dirs) const {
+	auto count = NeighbourCount(w, h);
+	for (const auto& dir : dirs) {
+		// the neighbour in direction dir is counted at the cell, i.e. shift it back by -dir
+		count.add(shifted(-dir.x(), -dir.y()));
+	}
+	return count;
+}
+
+BitGrid BitGrid::operator~() const {
+	auto result = *this;
+	for (auto& word : result.words) {
+		word = ~word;
+	}
+	result.clear_padding_bits();
+	return result;
+}
+
+BitGrid& BitGrid::operator&=(const BitGrid& other) {
+	check_dims(other);
+	for (size_t i = 0; i < words.size(); ++i) {
+		words[i] &= other.words[i];
+	}
+	return *this;
+}
+
+BitGrid& BitGrid::operator|=(const BitGrid& other) {
+	check_dims(other);
+	for (size_t i = 0; i < words.size(); ++i) {
+		words[i] |= other.words[i];
+	}
+	return *this;
+}
+
+BitGrid& BitGrid::operator^=(const BitGrid& other) {
+	check_dims(other);
+	for (size_t i = 0; i < words.size(); ++i) {
+		words[i] ^= other.words[i];
+	}
+	return *this;
+}
+
+BitGrid& BitGrid::operator-=(const BitGrid& other) {
+	check_dims(other);
+	for (size_t i = 0; i < words.size(); ++i) {
+		words[i] &= ~other.words[i];
+	}
+	return *this;
+}
+
+size_t BitGrid::hash() const {
+	const uint64_t seed = hash_pair32(static_cast<uint32_t>(w), static_cast<uint32_t>(h));
+	return static_cast<size_t>(hash_bytes(words.data(), words.size() * sizeof(uint64_t), seed));
+}
+
+std::ostream& operator<<(std::ostream& os, const BitGrid& grid) {
+	for (int y = 0; y < grid.h; ++y) {
+		for (int x = 0; x < grid.w; ++x) {
+			os << (grid.get(x, y) ? '#' : '.');
+		}
+		os << '\n';
+	}
+	return os;
+}
+
+void BitGrid::check_dims(const BitGrid& other) const {
+	if (w != other.w || h != other.h) {
+		Logger::critical("BitGrid dimensions differ: {}x{} and {}x{}", w, h, other.w, other.h);
+	}
+}
+
+void BitGrid::clear_padding_bits() {
+	if (w % 64 == 0) return;
+	const uint64_t mask = (uint64_t{1} << (w % 64)) - 1;
+	for (int y = 0; y < h; ++y) {
+		words[static_cast<size_t>(y) * row_words + row_words - 1] &= mask;
+	}
+}
+
+void BitGrid::NeighbourCount::add(const BitGrid& grid) {
+	auto carry = grid;
+	for (auto& plane : planes) {
+		auto next_carry = plane & carry;
+		plane ^= carry;
+		carry = std::move(next_carry);
+		if (carry.none()) return;
+	}
+	if (carry.any()) {
+		planes.push_back(std::move(carry));
+	}
+}
+
+BitGrid BitGrid::NeighbourCount::equals(unsigned n) const {
+	if (n >> planes.size() != 0) {
+		return BitGrid(w, h);
+	}
+
+	auto result = BitGrid(w, h, true);
+	for (size_t i = 0; i < planes.size(); ++i) {
+		if ((n >> i) & 1) {
+			result &= planes[i];
+		} else {
+			result -= planes[i];
+		}
+	}
+	return result;
+}
+
+BitGrid BitGrid::NeighbourCount::at_least(unsigned n) const {
+	if (n == 0) {
+		return BitGrid(w, h, true);
+	}
+	if (n >> planes.size() != 0) {
+		return BitGrid(w, h);
+	}
+
+	// compare from the most significant plane: count > n once a higher bit is set where n has 0
+	auto greater = BitGrid(w, h);
+	auto equal = BitGrid(w, h, true);
+	for (size_t i = planes.size(); i-- > 0;) {
+		if ((n >> i) & 1) {
+			equal &= planes[i];
+		} else {
+			greater |= equal & planes[i];
+			equal -= planes[i];
+		}
+	}
+	return greater | equal;
+}
+
+unsigned BitGrid::NeighbourCount::get(const Vec2i& p) const {
+	unsigned count = 0;
+	for (size_t i = 0; i < planes.size(); ++i) {
+		count |= static_cast<unsigned>(planes[i].get(p)) << i;
+	}
+	return count;
+}
@@ -0,0 +1,185 @@
+#ifndef BITGRID_H
+#define BITGRID_H
+
+#include <cstdint>
+#include <ostream>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "Grid.h"
+#include "Matrix.h"
+
+/* ====================================================================================================
+ * Bit Grid
+ */
+
+/**
+ * Boolean grid with every row packed into 64-bit words (bit x % 64 of word x / 64 is cell x).
+ * Whole-grid operations work on 64 cells per instruction; bits past the width are always 0.
+ *
+ * Game of Life step:
+ *   auto count = alive.count_neighbours(all_dirs_diag());
+ *   alive = count.equals(3) | (alive & count.equals(2));
+ */
+class BitGrid {
+private:
+	int w = 0;
+	int h = 0;
+	int row_words = 0;
+	std::vector<uint64_t> words{};
+
+public:
+	BitGrid() = default;
+	BitGrid(int width, int height, bool value = false);
+
+	/**
+	 * @param view characters of the grid
+	 * @param on character of set cells
+	 */
+	static BitGrid from_view(const GridView<const char>& view, char on = '#');
+
+	/**
+	 * Builds a grid from lines of equal length (see grid_view)
+	 */
+	static BitGrid parse(std::string_view input, char on = '#');
+
+	int width() const { return w; }
+	int height() const { return h; }
+	Vec2i dims() const { return Vec2i{w, h}; }
+
+	bool inbounds(int x, int y) const { return x >= 0 && y >= 0 && x < w && y < h; }
+	bool inbounds(const Vec2i& p) const { return inbounds(p.x(), p.y()); }
+
+	bool get(int x, int y) const {
+		return (words[static_cast<size_t>(y) * row_words + (x >> 6)] >> (x & 63)) & 1;
+	}
+
+	bool get(const Vec2i& p) const { return get(p.x(), p.y()); }
+
+	/**
+	 * Like get but false outside of the grid
+	 */
+	bool test(const Vec2i& p) const { return inbounds(p) && get(p); }
+
+	void set(int x, int y, bool value = true) {
+		auto& word = words[static_cast<size_t>(y) * row_words + (x >> 6)];
+		const uint64_t bit = uint64_t{1} << (x & 63);
+		word = value ? word | bit : word & ~bit;
+	}
+
+	void set(const Vec2i& p, bool value = true) { set(p.x(), p.y(), value); }
+
+	/**
+	 * Sets the cell and returns whether it was unset before (for visited sets)
+	 */
+	bool insert(const Vec2i& p) {
+		if (get(p)) return false;
+		set(p);
+		return true;
+	}
+
+	void flip(int x, int y) {
+		words[static_cast<size_t>(y) * row_words + (x >> 6)] ^= uint64_t{1} << (x & 63);
+	}
+
+	void fill(bool value);
+
+	std::span<uint64_t> row(int y) { return std::span(words).subspan(static_cast<size_t>(y) * row_words, row_words); }
+	std::span<const uint64_t> row(int y) const { return std::span(words).subspan(static_cast<size_t>(y) * row_words, row_words); }
+
+	/**
+	 * Number of set cells
+	 */
+	size_t count() const;
+	bool any() const;
+	bool none() const { return !any(); }
+
+	/**
+	 * Positions of all set cells in row-major order
+	 */
+	std::vector<Vec2i> positions() const;
+
+	/**
+	 * Grid moved by (dx, dy): result(x + dx, y + dy) = this(x, y). Cells moved out are dropped.
+	 */
+	BitGrid shifted(int dx, int dy) const;
+	BitGrid shifted(const Vec2i& dir) const { return shifted(dir.x(), dir.y()); }
+
+	/**
+	 * Union of the grid shifted in every direction: cells with at least one set neighbour in dirs
+	 * (the cell itself is not included unless dirs contains (0, 0))
+	 */
+	BitGrid neighbours(const std::vector<Vec2i>& dirs) const;
+
+	class NeighbourCount;
+
+	/**
+	 * Counts the set neighbours of every cell in the given directions (all_dirs() / all_dirs_diag())
+	 */
+	NeighbourCount count_neighbours(const std::vector<Vec2i>& dirs) const;
+
+	BitGrid operator~() const;
+
+	BitGrid& operator&=(const BitGrid& other);
+	BitGrid& operator|=(const BitGrid& other);
+	BitGrid& operator^=(const BitGrid& other);
+
+	/**
+	 * Removes every cell set in other (this & ~other)
+	 */
+	BitGrid& operator-=(const BitGrid& other);
+
+	friend BitGrid operator&(BitGrid a, const BitGrid& b) { return a &= b; }
+	friend BitGrid operator|(BitGrid a, const BitGrid& b) { return a |= b; }
+	friend BitGrid operator^(BitGrid a, const BitGrid& b) { return a ^= b; }
+	friend BitGrid operator-(BitGrid a, const BitGrid& b) { return a -= b; }
+
+	bool operator==(const BitGrid& other) const = default;
+
+	size_t hash() const;
+
+	friend std::ostream& operator<<(std::ostream& os, const BitGrid& grid);
+
+private:
+	void check_dims(const BitGrid& other) const;
+	void clear_padding_bits();
+};
+
+/**
+ * Per-cell counters stored as bit planes (plane i holds bit i of every cell's count), so that
+ * adding a whole grid is a word-parallel ripple-carry addition.
+ */
+class BitGrid::NeighbourCount {
+private:
+	int w;
+	int h;
+	std::vector<BitGrid> planes{};
+
+public:
+	NeighbourCount(int width, int height) : w(width), h(height) {}
+
+	/**
+	 * Adds 1 to the count of every cell set in grid
+	 */
+	void add(const BitGrid& grid);
+
+	/**
+	 * Cells whose count is exactly n
+	 */
+	BitGrid equals(unsigned n) const;
+
+	/**
+	 * Cells whose count is at least n
+	 */
+	BitGrid at_least(unsigned n) const;
+
+	unsigned get(const Vec2i& p) const;
+};
+
+template<>
+struct std::hash<BitGrid> {
+	size_t operator()(const BitGrid& grid) const { return grid.hash(); }
+};
+
+#endif //BITGRID_H
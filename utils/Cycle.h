@@ -0,0 +1,160 @@
+#ifndef CYCLE_H
+#define CYCLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <ranges>
+#include <type_traits>
+
+#include "FlatMap.h"
+#include "Hash.h"
+
+/* ====================================================================================================
+ * Cycle detection
+ *
+ * For simulations that repeat after a while and are asked for the state after 10^9 steps.
+ *   step(state)    advances the state by one step, either in place (returning void) or by
+ *                  returning the next state
+ *   hash(state)    64-bit fingerprint; states are only compared by fingerprint, so no snapshots
+ *                  are kept (a false match has a probability of about steps^2 / 2^64)
+ *
+ * Grid<T>, BitGrid and everything with a std::hash work directly, as do ranges of those
+ * (e.g. std::vector<std::string>):
+ *   auto grid = Grid<char>::parse(input);
+ *   simulate(grid, 1'000'000'000, [](Grid<char>& g) { tilt(g); g = g.rotated90c().to_grid(); });
+ */
+
+struct Cycle {
+	bool found = false;
+	/** first step of the cycle: state(start) == state(start + length) */
+	size_t start = 0;
+	size_t length = 0;
+
+	/**
+	 * Smallest step with the same state as step n
+	 */
+	size_t equivalent(size_t n) const {
+		return !found || n < start ? n : start + (n - start) % length;
+	}
+};
+
+/**
+ * std::hash if there is one, otherwise the combined hashes of the elements of a range
+ */
+template<typename State>
+struct StateHash {
+	size_t operator()(const State& state) const {
+		if constexpr (std::is_default_constructible_v<std::hash<State>>) {
+			return std::hash<State>()(state);
+		} else {
+			static_assert(std::ranges::range<State>, "StateHash needs a std::hash or a range; pass a hasher instead");
+			size_t hash = 0;
+			for (const auto& element : state) {
+				hash = hash_combine(hash, StateHash<std::ranges::range_value_t<State>>()(element));
+			}
+			return hash;
+		}
+	}
+};
+
+template<typename State, typename Step>
+void advance_state(State& state, Step& step) {
+	if constexpr (std::is_void_v<std::invoke_result_t<Step&, State&>>) {
+		step(state);
+	} else {
+		state = step(state);
+	}
+}
+
+/**
+ * Finds the cycle by remembering the fingerprint of every step (16 bytes per step, one pass)
+ * @param limit number of steps after which the search gives up
+ */
+template<typename State, typename Step, typename Hash = StateHash<State>>
+Cycle find_cycle(State state, Step step, Hash hash = {}, size_t limit = SIZE_MAX) {
+	FlatMap<uint64_t, size_t> seen{};
+	for (size_t i = 0; i < limit; ++i) {
+		auto [it, inserted] = seen.try_emplace(hash(state), i);
+		if (!inserted) {
+			return Cycle{true, it->second, i - it->second};
+		}
+		advance_state(state, step);
+	}
+	return Cycle{};
+}
+
+/**
+ * Finds the cycle with Brent's algorithm: constant memory (two states), about
+ * 2 * start + 3 * length steps
+ * @param limit number of steps after which the search gives up
+ */
+template<typename State, typename Step, typename Hash = StateHash<State>>
+Cycle find_cycle_brent(const State& initial, Step step, Hash hash = {}, size_t limit = SIZE_MAX) {
+	// the hare runs ahead; the tortoise (only its fingerprint) jumps to the hare after 1, 2, 4, ... steps
+	State hare = initial;
+	uint64_t tortoise = hash(hare);
+	advance_state(hare, step);
+	size_t power = 1;
+	size_t length = 1;
+	for (size_t steps = 1; tortoise != hash(hare); ++steps) {
+		if (steps >= limit) {
+			return Cycle{};
+		}
+		if (power == length) {
+			tortoise = hash(hare);
+			power *= 2;
+			length = 0;
+		}
+		advance_state(hare, step);
+		++length;
+	}
+
+	// with a head start of one cycle length the two states meet at the start of the cycle
+	State slow = initial;
+	State fast = initial;
+	for (size_t i = 0; i < length; ++i) {
+		advance_state(fast, step);
+	}
+	size_t start = 0;
+	while (hash(slow) != hash(fast)) {
+		advance_state(slow, step);
+		advance_state(fast, step);
+		++start;
+	}
+	return Cycle{true, start, length};
+}
+
+/**
+ * State after n steps, simulating only cycle.equivalent(n) of them
+ */
+template<typename State, typename Step>
+State state_at(State state, size_t n, Step step, const Cycle& cycle) {
+	for (size_t i = cycle.equivalent(n); i > 0; --i) {
+		advance_state(state, step);
+	}
+	return state;
+}
+
+/**
+ * Advances state by steps; once a fingerprint repeats, the remaining whole cycles are skipped
+ * @return the detected cycle (found is false if none showed up within steps)
+ */
+template<typename State, typename Step, typename Hash = StateHash<State>>
+Cycle simulate(State& state, size_t steps, Step step, Hash hash = {}) {
+	FlatMap<uint64_t, size_t> seen{};
+	for (size_t i = 0; i < steps; ++i) {
+		auto [it, inserted] = seen.try_emplace(hash(state), i);
+		if (!inserted) {
+			const Cycle cycle{true, it->second, i - it->second};
+			for (size_t rest = (steps - i) % cycle.length; rest > 0; --rest) {
+				advance_state(state, step);
+			}
+			return cycle;
+		}
+		advance_state(state, step);
+	}
+	return Cycle{};
+}
+
+#endif //CYCLE_H
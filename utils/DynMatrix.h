@@ -0,0 +1,500 @@
+#ifndef DYNMATRIX_H
+#define DYNMATRIX_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <ostream>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+#include <Logger.h>
+
+/* ====================================================================================================
+ * Runtime-sized Matrix
+ */
+
+/**
+ * Dense row-major matrix whose dimensions are only known at runtime (e.g. after parsing);
+ * same element requirements as Matrix (T(0), T(1), + - *), so ModInt<P> works as well.
+ * Row reduction additionally needs division: exact for Rational<I> and ModInt<P> (prime P),
+ * approximate for floating point. DynMatrix<bool> is a bit-packed specialization over GF(2).
+ */
+template<typename T>
+class DynMatrix {
+private:
+	int m = 0;
+	int n = 0;
+	std::vector<T> cells{};
+
+public:
+	DynMatrix() = default;
+
+	DynMatrix(int rows, int cols, T fill = static_cast<T>(0))
+		: m(rows), n(cols), cells(static_cast<size_t>(rows) * cols, fill) {}
+
+	static DynMatrix identity(int size) {
+		DynMatrix result(size, size);
+		for (int i = 0; i < size; i++) {
+			result(i, i) = static_cast<T>(1);
+		}
+		return result;
+	}
+
+	int rows() const { return m; }
+	int cols() const { return n; }
+
+	T* data() { return cells.data(); }
+	const T* data() const { return cells.data(); }
+
+	T& operator()(int i, int j) { return cells[static_cast<size_t>(i) * n + j]; }
+	const T& operator()(int i, int j) const { return cells[static_cast<size_t>(i) * n + j]; }
+
+	std::span<T> row(int i) { return std::span(cells).subspan(static_cast<size_t>(i) * n, n); }
+	std::span<const T> row(int i) const { return std::span(cells).subspan(static_cast<size_t>(i) * n, n); }
+
+	DynMatrix operator+(const DynMatrix& other) const {
+		check_dims(other, "+");
+		DynMatrix result(*this);
+		for (size_t i = 0; i < cells.size(); i++) {
+			result.cells[i] += other.cells[i];
+		}
+		return result;
+	}
+
+	DynMatrix operator-(const DynMatrix& other) const {
+		check_dims(other, "-");
+		DynMatrix result(*this);
+		for (size_t i = 0; i < cells.size(); i++) {
+			result.cells[i] -= other.cells[i];
+		}
+		return result;
+	}
+
+	/**
+	 * Matrix product in i-k-j order, so that the inner loop runs along rows of both operands
+	 */
+	DynMatrix operator*(const DynMatrix& other) const {
+		if (n != other.m) {
+			Logger::critical("DynMatrix: cannot multiply {}x{} with {}x{}", m, n, other.m, other.n);
+		}
+		DynMatrix result(m, other.n);
+		for (int i = 0; i < m; i++) {
+			auto out = result.row(i);
+			for (int k = 0; k < n; k++) {
+				const T a = (*this)(i, k);
+				if (a == static_cast<T>(0)) continue;
+				const auto b = other.row(k);
+				for (int j = 0; j < other.n; j++) {
+					out[j] += a * b[j];
+				}
+			}
+		}
+		return result;
+	}
+
+	/**
+	 * Matrix times column vector
+	 */
+	std::vector<T> operator*(std::span<const T> v) const {
+		if (static_cast<size_t>(n) != v.size()) {
+			Logger::critical("DynMatrix: cannot multiply {}x{} with a vector of size {}", m, n, v.size());
+		}
+		std::vector<T> result(m, static_cast<T>(0));
+		for (int i = 0; i < m; i++) {
+			const auto r = row(i);
+			for (int j = 0; j < n; j++) {
+				result[i] += r[j] * v[j];
+			}
+		}
+		return result;
+	}
+
+	/**
+	 * this^k by binary exponentiation, O(n^3 log k)
+	 */
+	DynMatrix pow(uint64_t k) const {
+		if (m != n) {
+			Logger::critical("DynMatrix: pow needs a square matrix, got {}x{}", m, n);
+		}
+		auto result = identity(m);
+		auto base = *this;
+		for (; k > 0; k >>= 1) {
+			if (k & 1) result = result * base;
+			if (k > 1) base = base * base;
+		}
+		return result;
+	}
+
+	DynMatrix transposed() const {
+		DynMatrix result(n, m);
+		for (int i = 0; i < m; i++) {
+			for (int j = 0; j < n; j++) {
+				result(j, i) = (*this)(i, j);
+			}
+		}
+		return result;
+	}
+
+	/**
+	 * Reduces this matrix in place to reduced row echelon form, placing pivots only in the first
+	 * `limit` columns (all by default; cols() - 1 leaves the right-hand side of an augmented matrix alone).
+	 * Returns the pivot column of every non-zero row, so its size is the rank.
+	 * Floating T pivots on the largest entry and treats entries within a relative tolerance as zero.
+	 */
+	std::vector<int> row_reduce(int limit = -1) requires (!std::numeric_limits<T>::is_integer) {
+		if (limit < 0 || limit > n) limit = n;
+		const T tolerance = zero_tolerance();
+		std::vector<int> pivots{};
+		for (int c = 0, r = 0; c < limit && r < m; c++) {
+			int best = -1;
+			for (int i = r; i < m; i++) {
+				if (negligible((*this)(i, c), tolerance)) continue;
+				if constexpr (std::is_floating_point_v<T>) {
+					if (best < 0 || std::abs((*this)(i, c)) > std::abs((*this)(best, c))) best = i;
+				} else {
+					best = i;
+					break;
+				}
+			}
+			if (best < 0) continue;
+			if (best != r) {
+				std::ranges::swap_ranges(row(best), row(r));
+			}
+
+			const auto pivot_row = row(r);
+			const T scale = static_cast<T>(1) / pivot_row[c];
+			for (int j = c + 1; j < n; j++) {
+				pivot_row[j] *= scale;
+			}
+			pivot_row[c] = static_cast<T>(1);
+			for (int i = 0; i < m; i++) {
+				if (i == r) continue;
+				const auto target = row(i);
+				const T factor = target[c];
+				if (factor == static_cast<T>(0)) continue;
+				for (int j = c + 1; j < n; j++) {
+					target[j] -= factor * pivot_row[j];
+				}
+				target[c] = static_cast<T>(0);
+			}
+			pivots.push_back(c);
+			r++;
+		}
+		return pivots;
+	}
+
+	int rank() const requires (!std::numeric_limits<T>::is_integer) {
+		auto reduced = *this;
+		return static_cast<int>(reduced.row_reduce().size());
+	}
+
+	/**
+	 * Basis of { x | this * x = 0 }, one vector per row (cols() - rank() rows of size cols())
+	 */
+	DynMatrix nullspace() const requires (!std::numeric_limits<T>::is_integer) {
+		auto reduced = *this;
+		const auto pivots = reduced.row_reduce();
+		std::vector<bool> is_pivot(n, false);
+		for (const int c : pivots) {
+			is_pivot[c] = true;
+		}
+		DynMatrix basis(n - static_cast<int>(pivots.size()), n);
+		for (int free = 0, k = 0; free < n; free++) {
+			if (is_pivot[free]) continue;
+			basis(k, free) = static_cast<T>(1);
+			for (size_t r = 0; r < pivots.size(); r++) {
+				basis(k, pivots[r]) = -reduced(static_cast<int>(r), free);
+			}
+			k++;
+		}
+		return basis;
+	}
+
+	/**
+	 * One solution of this * x = b (free variables set to 0), or nullopt if there is none.
+	 * All solutions are x plus any combination of the rows of nullspace().
+	 */
+	std::optional<std::vector<T>> solve(std::span<const T> b) const requires (!std::numeric_limits<T>::is_integer) {
+		if (static_cast<size_t>(m) != b.size()) {
+			Logger::critical("DynMatrix: cannot solve {}x{} with a right-hand side of size {}", m, n, b.size());
+		}
+		DynMatrix augmented(m, n + 1);
+		for (int i = 0; i < m; i++) {
+			std::ranges::copy(row(i), augmented.row(i).begin());
+			augmented(i, n) = b[i];
+		}
+		const T tolerance = augmented.zero_tolerance();
+		const auto pivots = augmented.row_reduce(n);
+		for (int i = static_cast<int>(pivots.size()); i < m; i++) {
+			if (!negligible(augmented(i, n), tolerance)) return std::nullopt;
+		}
+		std::vector<T> x(n, static_cast<T>(0));
+		for (size_t r = 0; r < pivots.size(); r++) {
+			x[pivots[r]] = augmented(static_cast<int>(r), n);
+		}
+		return x;
+	}
+
+	bool operator==(const DynMatrix& other) const = default;
+
+	friend std::ostream& operator<<(std::ostream& os, const DynMatrix& matrix) {
+		for (int i = 0; i < matrix.m; i++) {
+			os << (i == 0 ? "{{" : " {");
+			for (int j = 0; j < matrix.n; j++) {
+				if (j != 0) os << ", ";
+				os << matrix(i, j);
+			}
+			os << (i == matrix.m - 1 ? "}}" : "},\n");
+		}
+		return os;
+	}
+
+private:
+	void check_dims(const DynMatrix& other, const char* op) const {
+		if (m != other.m || n != other.n) {
+			Logger::critical("DynMatrix: cannot {} {}x{} and {}x{}", op, m, n, other.m, other.n);
+		}
+	}
+
+	// 0 for exact types; for floating point scaled by the largest entry and the dimensions
+	T zero_tolerance() const {
+		if constexpr (std::is_floating_point_v<T>) {
+			T largest = 0;
+			for (const T& value : cells) {
+				largest = std::max(largest, std::abs(value));
+			}
+			return largest * static_cast<T>(16 * std::max(m, n)) * std::numeric_limits<T>::epsilon();
+		} else {
+			return static_cast<T>(0);
+		}
+	}
+
+	static bool negligible(const T& value, const T& tolerance) {
+		if constexpr (std::is_floating_point_v<T>) {
+			return std::abs(value) <= tolerance;
+		} else {
+			return value == static_cast<T>(0);
+		}
+	}
+};
+
+/**
+ * Bit-packed matrix over GF(2): every row is a run of 64-bit words (bit j of a row is column j), so
+ * addition is XOR and row operations handle 64 columns per instruction. Intended for toggle puzzles
+ * (buttons flipping lights): rows are lights, columns are buttons, solve(target) gives one set of
+ * presses, nullspace() the combinations that change nothing.
+ */
+template<>
+class DynMatrix<bool> {
+private:
+	int m = 0;
+	int n = 0;
+	int words = 0;
+	std::vector<uint64_t> bits{};
+
+	static constexpr uint64_t mask(int j) { return uint64_t{1} << (j & 63); }
+
+public:
+	DynMatrix() = default;
+
+	DynMatrix(int rows, int cols, bool fill = false)
+		: m(rows), n(cols), words((cols + 63) / 64), bits(static_cast<size_t>(rows) * words, 0) {
+		if (fill) {
+			for (int i = 0; i < m; i++) {
+				for (int j = 0; j < n; j++) {
+					set(i, j, true);
+				}
+			}
+		}
+	}
+
+	static DynMatrix identity(int size) {
+		DynMatrix result(size, size);
+		for (int i = 0; i < size; i++) {
+			result.set(i, i, true);
+		}
+		return result;
+	}
+
+	int rows() const { return m; }
+	int cols() const { return n; }
+
+	bool operator()(int i, int j) const { return get(i, j); }
+	bool get(int i, int j) const { return (row_words(i)[j >> 6] & mask(j)) != 0; }
+
+	void set(int i, int j, bool value) {
+		auto& word = row_words(i)[j >> 6];
+		word = value ? word | mask(j) : word & ~mask(j);
+	}
+
+	void flip(int i, int j) { row_words(i)[j >> 6] ^= mask(j); }
+
+	/**
+	 * The packed words of row i; bits at or beyond cols() must stay 0
+	 */
+	std::span<uint64_t> row_words(int i) { return std::span(bits).subspan(static_cast<size_t>(i) * words, words); }
+	std::span<const uint64_t> row_words(int i) const { return std::span(bits).subspan(static_cast<size_t>(i) * words, words); }
+
+	DynMatrix operator+(const DynMatrix& other) const {
+		if (m != other.m || n != other.n) {
+			Logger::critical("DynMatrix: cannot + {}x{} and {}x{}", m, n, other.m, other.n);
+		}
+		DynMatrix result(*this);
+		for (size_t i = 0; i < bits.size(); i++) {
+			result.bits[i] ^= other.bits[i];
+		}
+		return result;
+	}
+
+	/**
+	 * Product over GF(2): row i of the result is the XOR of the rows of other selected by row i of this
+	 */
+	DynMatrix operator*(const DynMatrix& other) const {
+		if (n != other.m) {
+			Logger::critical("DynMatrix: cannot multiply {}x{} with {}x{}", m, n, other.m, other.n);
+		}
+		DynMatrix result(m, other.n);
+		for (int i = 0; i < m; i++) {
+			const auto out = result.row_words(i);
+			for (int k = 0; k < n; k++) {
+				if (!get(i, k)) continue;
+				const auto source = other.row_words(k);
+				for (int w = 0; w < other.words; w++) {
+					out[w] ^= source[w];
+				}
+			}
+		}
+		return result;
+	}
+
+	/**
+	 * Same contract as the generic row_reduce; elimination is a word-wise XOR from the pivot's word on
+	 */
+	std::vector<int> row_reduce(int limit = -1) {
+		if (limit < 0 || limit > n) limit = n;
+		std::vector<int> pivots{};
+		for (int c = 0, r = 0; c < limit && r < m; c++) {
+			const int word = c >> 6;
+			int found = r;
+			while (found < m && !(bits[static_cast<size_t>(found) * words + word] & mask(c))) {
+				found++;
+			}
+			if (found == m) continue;
+			if (found != r) {
+				std::ranges::swap_ranges(row_words(found), row_words(r));
+			}
+			const auto pivot_row = row_words(r);
+			for (int i = 0; i < m; i++) {
+				if (i == r) continue;
+				const auto target = row_words(i);
+				if (!(target[word] & mask(c))) continue;
+				for (int w = word; w < words; w++) {
+					target[w] ^= pivot_row[w];
+				}
+			}
+			pivots.push_back(c);
+			r++;
+		}
+		return pivots;
+	}
+
+	int rank() const {
+		auto reduced = *this;
+		return static_cast<int>(reduced.row_reduce().size());
+	}
+
+	/**
+	 * Basis of { x | this * x = 0 }, one vector per row; every subset of the rows XORed together is a
+	 * distinct element, so there are 2^(cols() - rank()) of them
+	 */
+	DynMatrix nullspace() const {
+		auto reduced = *this;
+		const auto pivots = reduced.row_reduce();
+		std::vector<bool> is_pivot(n, false);
+		for (const int c : pivots) {
+			is_pivot[c] = true;
+		}
+		DynMatrix basis(n - static_cast<int>(pivots.size()), n);
+		for (int free = 0, k = 0; free < n; free++) {
+			if (is_pivot[free]) continue;
+			basis.set(k, free, true);
+			for (size_t r = 0; r < pivots.size(); r++) {
+				if (reduced.get(static_cast<int>(r), free)) {
+					basis.set(k, pivots[r], true);
+				}
+			}
+			k++;
+		}
+		return basis;
+	}
+
+	/**
+	 * One solution of this * x = b (free variables set to 0), or nullopt if there is none
+	 */
+	std::optional<std::vector<bool>> solve(const std::vector<bool>& b) const {
+		if (static_cast<size_t>(m) != b.size()) {
+			Logger::critical("DynMatrix: cannot solve {}x{} with a right-hand side of size {}", m, n, b.size());
+		}
+		DynMatrix augmented(m, n + 1);
+		for (int i = 0; i < m; i++) {
+			std::ranges::copy(row_words(i), augmented.row_words(i).begin());
+			augmented.set(i, n, b[i]);
+		}
+		const auto pivots = augmented.row_reduce(n);
+		for (int i = static_cast<int>(pivots.size()); i < m; i++) {
+			if (augmented.get(i, n)) return std::nullopt;
+		}
+		std::vector<bool> x(n, false);
+		for (size_t r = 0; r < pivots.size(); r++) {
+			x[pivots[r]] = augmented.get(static_cast<int>(r), n);
+		}
+		return x;
+	}
+
+	bool operator==(const DynMatrix& other) const = default;
+
+	friend std::ostream& operator<<(std::ostream& os, const DynMatrix& matrix) {
+		for (int i = 0; i < matrix.m; i++) {
+			os << (i == 0 ? "{{" : " {");
+			for (int j = 0; j < matrix.n; j++) {
+				if (j != 0) os << ", ";
+				os << matrix.get(i, j);
+			}
+			os << (i == matrix.m - 1 ? "}}" : "},\n");
+		}
+		return os;
+	}
+};
+
+/**
+ * Term n of the linear recurrence a(t) = coefficients[0] * a(t-1) + ... + coefficients[d-1] * a(t-d)
+ * given a(0) ... a(d-1), via the d x d companion matrix: O(d^3 log n)
+ */
+template<typename T>
+T linear_recurrence(std::span<const T> coefficients, std::span<const T> initial, uint64_t n) {
+	const int d = static_cast<int>(coefficients.size());
+	if (initial.size() != coefficients.size() || d == 0) {
+		Logger::critical("linear_recurrence: needs as many initial values as coefficients (got {} / {})", initial.size(), d);
+	}
+	if (n < static_cast<uint64_t>(d)) {
+		return initial[n];
+	}
+
+	// state(t) = (a(t + d - 1), ..., a(t)); state(t + 1) = companion * state(t)
+	DynMatrix<T> companion(d, d);
+	for (int j = 0; j < d; j++) {
+		companion(0, j) = coefficients[j];
+	}
+	for (int i = 1; i < d; i++) {
+		companion(i, i - 1) = static_cast<T>(1);
+	}
+	std::vector<T> state(initial.rbegin(), initial.rend());
+	return (companion.pow(n - d + 1) * std::span<const T>(state))[0];
+}
+
+#endif //DYNMATRIX_H
@@ -0,0 +1,130 @@
+#include "FlatMap.h"
+
+#include "utils.h"
+
+#include <random>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace {
+
+/**
+ * Inserts a key; maps store the key's position as value so lookups have something to read
+ */
+template<typename Table, typename Key>
+void insert_key(Table& table, const Key& key, size_t index) {
+	if constexpr (requires { typename Table::mapped_type; }) {
+		table.try_emplace(key, index);
+	} else {
+		table.insert(key);
+	}
+}
+
+/**
+ * Runs insert, lookup (hit and miss) and erase on the given set or map type and logs
+ * million operations per second (median over the runs)
+ */
+template<typename Table, typename Key>
+void bench_table(const char* name, const std::vector<Key>& keys, const std::vector<Key>& lookups, const std::vector<Key>& misses, unsigned runs) {
+	auto measure = [&](auto&& prepare, auto&& fn) {
+		size_t ops = 0;
+		const auto stats = time_runs(runs, [&](Table& table) { ops = fn(table); }, [&] { return Table(prepare()); });
+		return per_second(ops, stats.median) / 1e6;
+	};
+
+	auto insert_all = [&](Table& table) {
+		for (size_t i = 0; i < keys.size(); ++i) insert_key(table, keys[i], i);
+		return keys.size();
+	};
+	auto empty = [] { return Table(); };
+	auto filled = [&] {
+		Table table;
+		insert_all(table);
+		return table;
+	};
+
+	const double insert = measure(empty, insert_all);
+	const double insert_reserved = measure([&] { Table table; table.reserve(keys.size()); return table; }, insert_all);
+
+	// every run publishes its lookup results, so the probes cannot be optimized away
+	volatile size_t sink = 0;
+	auto lookup = [&](const Table& table, const Key& key) -> size_t {
+		if constexpr (requires { typename Table::mapped_type; }) {
+			auto it = table.find(key);
+			return it != table.end() ? it->second + 1 : 0;
+		} else {
+			return table.contains(key);
+		}
+	};
+	const double hit = measure(filled, [&](Table& table) {
+		size_t found = 0;
+		for (const auto& key : lookups) found += lookup(table, key);
+		sink = found;
+		return lookups.size();
+	});
+	const double miss = measure(filled, [&](Table& table) {
+		size_t found = 0;
+		for (const auto& key : misses) found += lookup(table, key);
+		sink = found;
+		return misses.size();
+	});
+	const double erase = measure(filled, [&](Table& table) {
+		size_t erased = 0;
+		for (const auto& key : lookups) erased += table.erase(key);
+		sink = erased;
+		return lookups.size();
+	});
+
+	Logger::info("{:<40} insert {:>7.2f} | reserved {:>7.2f} | hit {:>7.2f} | miss {:>7.2f} | erase {:>7.2f} M ops/s",
+		name, insert, insert_reserved, hit, miss, erase);
+}
+
+template<typename Key>
+std::vector<Key> shuffled(const std::vector<Key>& keys, std::mt19937& rng) {
+	std::vector<size_t> permutation(keys.size());
+	std::iota(permutation.begin(), permutation.end(), 0);
+	std::shuffle(permutation.begin(), permutation.end(), rng);
+	auto result = keys;
+	for (size_t i = 0; i < keys.size(); ++i) {
+		result[i] = keys[permutation[i]];
+	}
+	return result;
+}
+
+}
+
+void bench_flat_map(size_t n, unsigned runs) {
+	Logger::init();
+	std::mt19937 rng(42);
+
+	// dense square of coordinates around 0; misses are the ring just outside of it
+	const int side = static_cast<int>(std::sqrt(static_cast<double>(n)));
+	std::vector<Vec2i> coords(static_cast<size_t>(side) * side);
+	std::vector<Vec2i> coord_misses(static_cast<size_t>(side) * side);
+	for (int y = 0; y < side; ++y) {
+		for (int x = 0; x < side; ++x) {
+			coords[static_cast<size_t>(y) * side + x] = Vec2i{x - side / 2, y - side / 2};
+			coord_misses[static_cast<size_t>(y) * side + x] = Vec2i{x - side / 2, y + side - side / 2};
+		}
+	}
+	const auto coord_lookups = shuffled(coords, rng);
+
+	// packed search states: random 64-bit keys
+	std::vector<uint64_t> states(n);
+	std::vector<uint64_t> state_misses(n);
+	for (size_t i = 0; i < n; ++i) {
+		states[i] = rng() | static_cast<uint64_t>(rng()) << 32 | 1;
+		state_misses[i] = (rng() | static_cast<uint64_t>(rng()) << 32) & ~uint64_t{1};
+	}
+	const auto state_lookups = shuffled(states, rng);
+
+	Logger::info("{} Vec2i coordinates / {} uint64_t states, {} run(s) each", coords.size(), states.size(), runs);
+	bench_table<std::unordered_set<Vec2i>>("std::unordered_set<Vec2i>", coords, coord_lookups, coord_misses, runs);
+	bench_table<FlatSet<Vec2i>>("FlatSet<Vec2i>", coords, coord_lookups, coord_misses, runs);
+	bench_table<std::unordered_set<uint64_t>>("std::unordered_set<uint64_t>", states, state_lookups, state_misses, runs);
+	bench_table<FlatSet<uint64_t>>("FlatSet<uint64_t>", states, state_lookups, state_misses, runs);
+	bench_table<std::unordered_map<Vec2i, size_t>>("std::unordered_map<Vec2i, size_t>", coords, coord_lookups, coord_misses, runs);
+	bench_table<FlatMap<Vec2i, size_t>>("FlatMap<Vec2i, size_t>", coords, coord_lookups, coord_misses, runs);
+	bench_table<std::unordered_map<uint64_t, size_t>>("std::unordered_map<uint64_t, size_t>", states, state_lookups, state_misses, runs);
+	bench_table<FlatMap<uint64_t, size_t>>("FlatMap<uint64_t, size_t>", states, state_lookups, state_misses, runs);
+}
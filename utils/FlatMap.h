@@ -0,0 +1,579 @@
+#ifndef FLATMAP_H
+#define FLATMAP_H
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include <Logger.h>
+
+#include "Hash.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FLAT_MAP_SSE2
+#include <emmintrin.h>
+#endif
+
+/* ====================================================================================================
+ * Flat Hash Map / Set
+ */
+
+/**
+ * Default hasher of FlatMap/FlatSet. Small trivially copyable keys without padding bits (ints, Point,
+ * packed states, ...) are hashed straight from their bytes; everything else (e.g. Vec2i, strings)
+ * goes through std::hash.
+ * The table mixes the result with hash_mix, so the hasher does not need to spread bits itself.
+ */
+template<typename Key>
+struct FlatHash {
+	size_t operator()(const Key& key) const {
+		if constexpr (std::is_trivially_copyable_v<Key> && std::has_unique_object_representations_v<Key> && sizeof(Key) <= 8) {
+			uint64_t bits = 0;
+			std::memcpy(&bits, &key, sizeof(Key));
+			return static_cast<size_t>(bits);
+		} else {
+			return std::hash<Key>()(key);
+		}
+	}
+};
+
+namespace flat_map_detail {
+
+// control byte per slot: EMPTY/DELETED have the sign bit set, full slots store 7 bits of the hash
+constexpr int8_t EMPTY = -128;
+constexpr int8_t DELETED = -2;
+constexpr size_t GROUP_SIZE = 16;
+
+/**
+ * 16 control bytes that are matched at once (one SSE2 compare, scalar loop otherwise)
+ */
+class Group {
+private:
+#ifdef FLAT_MAP_SSE2
+	__m128i ctrl;
+#else
+	const int8_t* ctrl;
+#endif
+
+public:
+#ifdef FLAT_MAP_SSE2
+	explicit Group(const int8_t* pos) : ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pos))) {}
+
+	uint32_t match(int8_t h2) const {
+		return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl)));
+	}
+
+	uint32_t match_empty() const {
+		return match(EMPTY);
+	}
+
+	uint32_t match_empty_or_deleted() const {
+		return static_cast<uint32_t>(_mm_movemask_epi8(ctrl));
+	}
+#else
+	explicit Group(const int8_t* pos) : ctrl(pos) {}
+
+	uint32_t match(int8_t h2) const {
+		uint32_t mask = 0;
+		for (size_t i = 0; i < GROUP_SIZE; ++i) {
+			mask |= static_cast<uint32_t>(ctrl[i] == h2) << i;
+		}
+		return mask;
+	}
+
+	uint32_t match_empty() const {
+		return match(EMPTY);
+	}
+
+	uint32_t match_empty_or_deleted() const {
+		uint32_t mask = 0;
+		for (size_t i = 0; i < GROUP_SIZE; ++i) {
+			mask |= static_cast<uint32_t>(ctrl[i] < 0) << i;
+		}
+		return mask;
+	}
+#endif
+};
+
+template<typename Key, typename Value>
+struct MapPolicy {
+	using value_type = std::pair<const Key, Value>;
+	static const Key& key(const value_type& value) { return value.first; }
+};
+
+template<typename Key>
+struct SetPolicy {
+	using value_type = Key;
+	static const Key& key(const value_type& value) { return value; }
+};
+
+/**
+ * Open addressing table in the style of Swiss tables: slots are probed group by group with
+ * quadratic steps, a group is checked for 7 bits of the hash in one compare and the probe
+ * stops at the first group that has an empty slot. Erased slots become tombstones.
+ */
+template<typename Key, typename Policy, typename Hash, typename Equal>
+class FlatTable {
+public:
+	using key_type = Key;
+	using value_type = typename Policy::value_type;
+	using size_type = size_t;
+	using hasher = Hash;
+	using key_equal = Equal;
+
+	template<bool Const>
+	class Iterator {
+	private:
+		using Table = std::conditional_t<Const, const FlatTable, FlatTable>;
+		Table* table = nullptr;
+		size_t index = 0;
+
+		friend class FlatTable;
+
+		void skip_free() {
+			while (index < table->slot_count && table->ctrl[index] < 0) {
+				++index;
+			}
+		}
+
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = typename Policy::value_type;
+		using difference_type = ptrdiff_t;
+		using pointer = std::conditional_t<Const, const value_type*, value_type*>;
+		using reference = std::conditional_t<Const, const value_type&, value_type&>;
+
+		Iterator() = default;
+		Iterator(Table* table, size_t index) : table(table), index(index) {}
+
+		operator Iterator<true>() const requires (!Const) { return Iterator<true>(table, index); }
+
+		reference operator*() const { return table->slots[index]; }
+		pointer operator->() const { return &table->slots[index]; }
+
+		Iterator& operator++() {
+			++index;
+			skip_free();
+			return *this;
+		}
+
+		Iterator operator++(int) {
+			auto copy = *this;
+			++*this;
+			return copy;
+		}
+
+		bool operator==(const Iterator& other) const { return index == other.index; }
+	};
+
+	using iterator = Iterator<false>;
+	using const_iterator = Iterator<true>;
+
+protected:
+	int8_t* ctrl = nullptr;
+	value_type* slots = nullptr;
+	size_t slot_count = 0;
+	size_t elements = 0;
+	// inserts into EMPTY slots left before the table has to grow or drop its tombstones
+	size_t growth_left = 0;
+
+	[[no_unique_address]] Hash hash_fn{};
+	[[no_unique_address]] Equal equal_fn{};
+
+public:
+	FlatTable() = default;
+
+	/**
+	 * @param expected number of elements that can be inserted without rehashing
+	 */
+	explicit FlatTable(size_t expected) {
+		reserve(expected);
+	}
+
+	FlatTable(const FlatTable& other) : hash_fn(other.hash_fn), equal_fn(other.equal_fn) {
+		reserve(other.elements);
+		for (const auto& value : other) {
+			auto [index, inserted] = find_or_prepare_insert(Policy::key(value));
+			std::construct_at(slots + index, value);
+		}
+	}
+
+	FlatTable(FlatTable&& other) noexcept {
+		swap(other);
+	}
+
+	FlatTable& operator=(FlatTable other) noexcept {
+		swap(other);
+		return *this;
+	}
+
+	~FlatTable() {
+		destroy();
+	}
+
+	void swap(FlatTable& other) noexcept {
+		std::swap(ctrl, other.ctrl);
+		std::swap(slots, other.slots);
+		std::swap(slot_count, other.slot_count);
+		std::swap(elements, other.elements);
+		std::swap(growth_left, other.growth_left);
+		std::swap(hash_fn, other.hash_fn);
+		std::swap(equal_fn, other.equal_fn);
+	}
+
+	size_t size() const { return elements; }
+	bool empty() const { return elements == 0; }
+	size_t capacity() const { return slot_count; }
+
+	iterator begin() {
+		auto it = iterator(this, 0);
+		if (slot_count != 0) it.skip_free();
+		return it;
+	}
+
+	const_iterator begin() const {
+		auto it = const_iterator(this, 0);
+		if (slot_count != 0) it.skip_free();
+		return it;
+	}
+
+	iterator end() { return iterator(this, slot_count); }
+	const_iterator end() const { return const_iterator(this, slot_count); }
+
+	/**
+	 * Makes room for n elements in total without further rehashing
+	 */
+	void reserve(size_t n) {
+		if (n <= elements + growth_left) return;
+		rehash(capacity_for(n));
+	}
+
+	void clear() {
+		destroy_slots();
+		if (slot_count != 0) {
+			std::memset(ctrl, EMPTY, slot_count);
+		}
+		elements = 0;
+		growth_left = max_load(slot_count);
+	}
+
+	iterator find(const Key& key) {
+		const size_t index = find_index(key);
+		return index == slot_count ? end() : iterator(this, index);
+	}
+
+	const_iterator find(const Key& key) const {
+		const size_t index = find_index(key);
+		return index == slot_count ? end() : const_iterator(this, index);
+	}
+
+	bool contains(const Key& key) const {
+		return find_index(key) != slot_count;
+	}
+
+	size_t count_of(const Key& key) const {
+		return contains(key) ? 1 : 0;
+	}
+
+	size_t erase(const Key& key) {
+		const size_t index = find_index(key);
+		if (index == slot_count) return 0;
+		erase_index(index);
+		return 1;
+	}
+
+	/**
+	 * @return iterator to the next element
+	 */
+	iterator erase(const_iterator it) {
+		erase_index(it.index);
+		auto next = iterator(this, it.index);
+		next.skip_free();
+		return next;
+	}
+
+	bool operator==(const FlatTable& other) const requires std::equality_comparable<value_type> {
+		if (elements != other.elements) return false;
+		for (const auto& value : *this) {
+			const size_t index = other.find_index(Policy::key(value));
+			if (index == other.slot_count || !(other.slots[index] == value)) return false;
+		}
+		return true;
+	}
+
+protected:
+	size_t hash(const Key& key) const {
+		return static_cast<size_t>(hash_mix(hash_fn(key)));
+	}
+
+	static int8_t h2(size_t hash) {
+		return static_cast<int8_t>(hash & 0x7F);
+	}
+
+	size_t group_mask() const {
+		return slot_count / GROUP_SIZE - 1;
+	}
+
+	static size_t max_load(size_t slots) {
+		return slots - slots / 8;
+	}
+
+	static size_t capacity_for(size_t n) {
+		const size_t needed = n + n / 7 + 1;
+		return std::max(GROUP_SIZE, std::bit_ceil(needed));
+	}
+
+	size_t find_index(const Key& key) const {
+		if (slot_count == 0) return slot_count;
+
+		const size_t h = hash(key);
+		const int8_t tag = h2(h);
+		size_t group = (h >> 7) & group_mask();
+		for (size_t step = 1; ; ++step) {
+			const size_t base = group * GROUP_SIZE;
+			const Group g(ctrl + base);
+			for (uint32_t mask = g.match(tag); mask != 0; mask &= mask - 1) {
+				const size_t index = base + std::countr_zero(mask);
+				if (equal_fn(Policy::key(slots[index]), key)) {
+					return index;
+				}
+			}
+			if (g.match_empty() != 0) {
+				return slot_count;
+			}
+			group = (group + step) & group_mask();
+		}
+	}
+
+	/**
+	 * First EMPTY or DELETED slot on the probe sequence of hash
+	 */
+	size_t find_free(size_t h) const {
+		size_t group = (h >> 7) & group_mask();
+		for (size_t step = 1; ; ++step) {
+			const size_t base = group * GROUP_SIZE;
+			const uint32_t mask = Group(ctrl + base).match_empty_or_deleted();
+			if (mask != 0) {
+				return base + std::countr_zero(mask);
+			}
+			group = (group + step) & group_mask();
+		}
+	}
+
+	/**
+	 * Index of key and false if it exists, otherwise a claimed slot (ctrl set, value not yet
+	 * constructed) and true
+	 */
+	std::pair<size_t, bool> find_or_prepare_insert(const Key& key) {
+		const size_t existing = find_index(key);
+		if (existing != slot_count) {
+			return {existing, false};
+		}
+
+		const size_t h = hash(key);
+		size_t index = slot_count == 0 ? 0 : find_free(h);
+		if (growth_left == 0 && (slot_count == 0 || ctrl[index] == EMPTY)) {
+			// many tombstones: clean up in place, otherwise grow
+			rehash(elements * 2 < max_load(slot_count) ? std::max(slot_count, GROUP_SIZE) : capacity_for(elements + 1));
+			index = find_free(h);
+		}
+
+		if (ctrl[index] == EMPTY) {
+			--growth_left;
+		}
+		ctrl[index] = h2(h);
+		++elements;
+		return {index, true};
+	}
+
+	void erase_index(size_t index) {
+		std::destroy_at(slots + index);
+		ctrl[index] = DELETED;
+		--elements;
+	}
+
+	void rehash(size_t new_slot_count) {
+		int8_t* old_ctrl = ctrl;
+		value_type* old_slots = slots;
+		const size_t old_slot_count = slot_count;
+
+		ctrl = new int8_t[new_slot_count];
+		std::memset(ctrl, EMPTY, new_slot_count);
+		slots = std::allocator<value_type>().allocate(new_slot_count);
+		slot_count = new_slot_count;
+		growth_left = max_load(new_slot_count) - elements;
+
+		for (size_t i = 0; i < old_slot_count; ++i) {
+			if (old_ctrl[i] < 0) continue;
+			const size_t h = hash(Policy::key(old_slots[i]));
+			const size_t index = find_free(h);
+			ctrl[index] = h2(h);
+			std::construct_at(slots + index, std::move(old_slots[i]));
+			std::destroy_at(old_slots + i);
+		}
+
+		delete[] old_ctrl;
+		if (old_slots != nullptr) {
+			std::allocator<value_type>().deallocate(old_slots, old_slot_count);
+		}
+	}
+
+	void destroy_slots() {
+		if constexpr (!std::is_trivially_destructible_v<value_type>) {
+			for (size_t i = 0; i < slot_count; ++i) {
+				if (ctrl[i] >= 0) {
+					std::destroy_at(slots + i);
+				}
+			}
+		}
+	}
+
+	void destroy() {
+		if (slot_count == 0) return;
+		destroy_slots();
+		delete[] ctrl;
+		std::allocator<value_type>().deallocate(slots, slot_count);
+		ctrl = nullptr;
+		slots = nullptr;
+		slot_count = 0;
+		elements = 0;
+		growth_left = 0;
+	}
+};
+
+}
+
+/**
+ * Open addressing hash map with SIMD group probing (see flat_map_detail::FlatTable).
+ * Mostly a drop-in replacement for std::unordered_map; unlike it, pointers and iterators are
+ * invalidated by inserts that rehash.
+ */
+template<typename Key, typename Value, typename Hash = FlatHash<Key>, typename Equal = std::equal_to<Key>>
+class FlatMap : public flat_map_detail::FlatTable<Key, flat_map_detail::MapPolicy<Key, Value>, Hash, Equal> {
+private:
+	using Base = flat_map_detail::FlatTable<Key, flat_map_detail::MapPolicy<Key, Value>, Hash, Equal>;
+
+public:
+	using mapped_type = Value;
+	using typename Base::iterator;
+	using typename Base::value_type;
+
+	using Base::Base;
+
+	FlatMap(std::initializer_list<value_type> values) : Base(values.size()) {
+		for (const auto& value : values) {
+			insert(value);
+		}
+	}
+
+	template<typename... Args>
+	std::pair<iterator, bool> try_emplace(const Key& key, Args&&... args) {
+		auto [index, inserted] = this->find_or_prepare_insert(key);
+		if (inserted) {
+			std::construct_at(this->slots + index, std::piecewise_construct,
+				std::forward_as_tuple(key), std::forward_as_tuple(std::forward<Args>(args)...));
+		}
+		return {iterator(this, index), inserted};
+	}
+
+	template<typename V>
+	std::pair<iterator, bool> emplace(const Key& key, V&& value) {
+		return try_emplace(key, std::forward<V>(value));
+	}
+
+	std::pair<iterator, bool> insert(const value_type& value) {
+		return try_emplace(value.first, value.second);
+	}
+
+	template<typename V>
+	std::pair<iterator, bool> insert_or_assign(const Key& key, V&& value) {
+		auto result = try_emplace(key, std::forward<V>(value));
+		if (!result.second) {
+			result.first->second = std::forward<V>(value);
+		}
+		return result;
+	}
+
+	Value& operator[](const Key& key) {
+		return try_emplace(key).first->second;
+	}
+
+	Value& at(const Key& key) {
+		auto it = this->find(key);
+		if (it == this->end()) {
+			Logger::critical("FlatMap::at: key not found");
+		}
+		return it->second;
+	}
+
+	const Value& at(const Key& key) const {
+		auto it = this->find(key);
+		if (it == this->end()) {
+			Logger::critical("FlatMap::at: key not found");
+		}
+		return it->second;
+	}
+
+	size_t count(const Key& key) const {
+		return this->count_of(key);
+	}
+};
+
+/**
+ * Open addressing hash set with SIMD group probing (see flat_map_detail::FlatTable)
+ */
+template<typename Key, typename Hash = FlatHash<Key>, typename Equal = std::equal_to<Key>>
+class FlatSet : public flat_map_detail::FlatTable<Key, flat_map_detail::SetPolicy<Key>, Hash, Equal> {
+private:
+	using Base = flat_map_detail::FlatTable<Key, flat_map_detail::SetPolicy<Key>, Hash, Equal>;
+
+public:
+	using typename Base::iterator;
+
+	using Base::Base;
+
+	FlatSet(std::initializer_list<Key> keys) : Base(keys.size()) {
+		for (const auto& key : keys) {
+			insert(key);
+		}
+	}
+
+	template<typename It>
+	FlatSet(It first, It last) {
+		for (; first != last; ++first) {
+			insert(*first);
+		}
+	}
+
+	std::pair<iterator, bool> insert(const Key& key) {
+		auto [index, inserted] = this->find_or_prepare_insert(key);
+		if (inserted) {
+			std::construct_at(this->slots + index, key);
+		}
+		return {iterator(this, index), inserted};
+	}
+
+	std::pair<iterator, bool> emplace(const Key& key) {
+		return insert(key);
+	}
+
+	size_t count(const Key& key) const {
+		return this->count_of(key);
+	}
+};
+
+/**
+ * Compares FlatMap/FlatSet with std::unordered_map/std::unordered_set on dense Vec2i coordinates
+ * and random 64-bit states (insert, lookup hit/miss, erase) and logs the throughput
+ * @param n number of keys
+ * @param runs measured runs per operation
+ */
+void bench_flat_map(size_t n = 1 << 20, unsigned runs = 5);
+
+#endif //FLATMAP_H
@@ -0,0 +1,383 @@
+#ifndef GRID_H
+#define GRID_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <optional>
+#include <ostream>
+#include <span>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include <Logger.h>
+
+#include "Hash.h"
+#include "Matrix.h"
+
+template<typename T>
+class Grid;
+
+/* ====================================================================================================
+ * Grid View
+ */
+
+/**
+ * Non-owning 2D view with arbitrary (also negative) strides. Transposing, rotating or taking a
+ * row/column only changes the strides, no cells are copied.
+ * view(x, y) = origin[x * step_x + y * step_y]
+ */
+template<typename T>
+class GridView {
+private:
+	T* origin = nullptr;
+	int w = 0;
+	int h = 0;
+	ptrdiff_t step_x = 1;
+	ptrdiff_t step_y = 0;
+
+public:
+	class Iterator {
+	private:
+		const GridView* view = nullptr;
+		int x = 0;
+		int y = 0;
+
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = std::remove_const_t<T>;
+		using difference_type = ptrdiff_t;
+		using pointer = T*;
+		using reference = T&;
+
+		Iterator() = default;
+		Iterator(const GridView* view, int x, int y) : view(view), x(x), y(y) {}
+
+		reference operator*() const { return (*view)(x, y); }
+		pointer operator->() const { return &(*view)(x, y); }
+
+		/**
+		 * Position of the current cell inside the view
+		 */
+		Vec2i pos() const { return Vec2i{x, y}; }
+
+		Iterator& operator++() {
+			if (++x == view->w) {
+				x = 0;
+				++y;
+			}
+			return *this;
+		}
+
+		Iterator operator++(int) {
+			auto copy = *this;
+			++*this;
+			return copy;
+		}
+
+		bool operator==(const Iterator& other) const { return x == other.x && y == other.y; }
+		bool operator==(std::default_sentinel_t) const { return y >= view->h || view->w == 0; }
+	};
+
+	GridView() = default;
+	GridView(T* origin, int width, int height, ptrdiff_t step_x, ptrdiff_t step_y)
+		: origin(origin), w(width), h(height), step_x(step_x), step_y(step_y) {}
+
+	operator GridView<const T>() const requires (!std::is_const_v<T>) {
+		return GridView<const T>(origin, w, h, step_x, step_y);
+	}
+
+	int width() const { return w; }
+	int height() const { return h; }
+	size_t size() const { return static_cast<size_t>(w) * h; }
+	Vec2i dims() const { return Vec2i{w, h}; }
+
+	bool inbounds(int x, int y) const { return x >= 0 && y >= 0 && x < w && y < h; }
+	bool inbounds(const Vec2i& p) const { return inbounds(p.x(), p.y()); }
+
+	T& operator()(int x, int y) const { return origin[x * step_x + y * step_y]; }
+	T& operator[](const Vec2i& p) const { return (*this)(p.x(), p.y()); }
+
+	T& at(const Vec2i& p) const {
+		if (!inbounds(p)) {
+			Logger::critical("Grid position ({}, {}) is out of bounds ({}x{})", p.x(), p.y(), w, h);
+		}
+		return (*this)[p];
+	}
+
+	Iterator begin() const { return Iterator(this, 0, 0); }
+	std::default_sentinel_t end() const { return {}; }
+
+	GridView row(int y) const { return GridView(&(*this)(0, y), w, 1, step_x, step_y); }
+	GridView col(int x) const { return GridView(&(*this)(x, 0), 1, h, step_x, step_y); }
+
+	GridView transposed() const { return GridView(origin, h, w, step_y, step_x); }
+
+	/**
+	 * Rotated clockwise: rotated(x, y) = view(y, height - 1 - x) (same orientation as rotate90c)
+	 */
+	GridView rotated90c() const { return GridView(&(*this)(0, h - 1), h, w, -step_y, step_x); }
+
+	/**
+	 * Rotated counter clockwise: rotated(x, y) = view(width - 1 - y, x) (same orientation as rotate90cc)
+	 */
+	GridView rotated90cc() const { return GridView(&(*this)(w - 1, 0), h, w, step_y, -step_x); }
+
+	GridView flipped_x() const { return GridView(&(*this)(w - 1, 0), w, h, -step_x, step_y); }
+	GridView flipped_y() const { return GridView(&(*this)(0, h - 1), w, h, step_x, -step_y); }
+
+	/**
+	 * Position of the first cell (row-major) equal to value
+	 */
+	std::optional<Vec2i> find(const std::remove_const_t<T>& value) const {
+		for (auto it = begin(); it != end(); ++it) {
+			if (*it == value) {
+				return it.pos();
+			}
+		}
+		return std::nullopt;
+	}
+
+	/**
+	 * Copies the view into a contiguous grid
+	 */
+	Grid<std::remove_const_t<T>> to_grid(int padding = 0, std::remove_const_t<T> border = {}) const {
+		auto grid = Grid<std::remove_const_t<T>>(w, h, border, padding, border);
+		for (int y = 0; y < h; ++y) {
+			for (int x = 0; x < w; ++x) {
+				grid(x, y) = (*this)(x, y);
+			}
+		}
+		return grid;
+	}
+
+	friend std::ostream& operator<<(std::ostream& os, const GridView& view) {
+		for (int y = 0; y < view.h; ++y) {
+			for (int x = 0; x < view.w; ++x) {
+				os << view(x, y);
+			}
+			os << '\n';
+		}
+		return os;
+	}
+};
+
+/**
+ * Zero-copy view over a block of equally long lines (e.g. a puzzle input). The line breaks
+ * are skipped through the row stride.
+ * @param input lines separated by '\n' or "\r\n"; trailing empty lines are ignored
+ */
+inline GridView<const char> grid_view(std::string_view input) {
+	while (!input.empty() && (input.back() == '\n' || input.back() == '\r')) {
+		input.remove_suffix(1);
+	}
+	if (input.empty()) {
+		return {};
+	}
+
+	size_t width = input.find('\n');
+	if (width == std::string_view::npos) {
+		return GridView<const char>(input.data(), static_cast<int>(input.size()), 1, 1, 0);
+	}
+
+	const size_t stride = width + 1;
+	if (width > 0 && input[width - 1] == '\r') {
+		--width;
+	}
+	// the last row has no line break after trimming
+	const size_t line_break = stride - width;
+	if ((input.size() + line_break) % stride != 0) {
+		Logger::critical("Grid rows have different lengths (expected {} characters per row)", width);
+	}
+	const size_t height = (input.size() + line_break) / stride;
+	for (size_t y = 1; y < height; ++y) {
+		if (input[y * stride - 1] != '\n') {
+			Logger::critical("Grid row {} does not have {} characters", y - 1, width);
+		}
+	}
+
+	return GridView<const char>(input.data(), static_cast<int>(width), static_cast<int>(height), 1,
+		static_cast<ptrdiff_t>(stride));
+}
+
+/* ====================================================================================================
+ * Grid
+ */
+
+/**
+ * Row-major 2D grid stored in a single buffer. An optional border of padding cells around the grid
+ * can hold a sentinel value so that neighbour lookups do not need bounds checks:
+ * coordinates from -padding to width + padding - 1 are valid.
+ *
+ * For BFS style loops the linear index can be used directly:
+ *   size_t i = grid.index(start);
+ *   size_t next = i + grid.offset(dir);   // grid[next] is the neighbour, no inbounds check with padding >= 1
+ */
+template<typename T>
+class Grid {
+	// std::vector<bool> packs bits and has no T& / T* / std::span to hand out
+	static_assert(!std::is_same_v<T, bool>, "Grid<bool> is not supported; use Grid<uint8_t> or BitGrid");
+
+private:
+	std::vector<T> cells{};
+	int w = 0;
+	int h = 0;
+	int pad = 0;
+
+public:
+	Grid() = default;
+
+	Grid(int width, int height, T fill = T{})
+		: cells(static_cast<size_t>(width) * height, fill), w(width), h(height) {}
+
+	/**
+	 * @param padding number of border cells on every side
+	 * @param border value of the border cells
+	 */
+	Grid(int width, int height, T fill, int padding, T border)
+		: cells(static_cast<size_t>(width + 2 * padding) * (height + 2 * padding), border),
+		  w(width), h(height), pad(padding) {
+		for (int y = 0; y < h; ++y) {
+			std::fill_n(cells.begin() + index(0, y), w, fill);
+		}
+	}
+
+	/**
+	 * Builds a grid from lines of equal length in one allocation
+	 * @param input lines separated by '\n' or "\r\n"
+	 * @param transform maps every character to a cell
+	 */
+	template<typename Fn> requires std::is_invocable_r_v<T, Fn&, char>
+	static Grid parse(std::string_view input, Fn transform, int padding = 0, T border = T{}) {
+		const auto view = grid_view(input);
+		auto grid = Grid(view.width(), view.height(), border, padding, border);
+		for (int y = 0; y < grid.h; ++y) {
+			T* row = &grid.cells[grid.index(0, y)];
+			const char* line = &view(0, y);
+			for (int x = 0; x < grid.w; ++x) {
+				row[x] = transform(line[x]);
+			}
+		}
+		return grid;
+	}
+
+	static Grid parse(std::string_view input, int padding = 0, T border = T{}) requires std::is_same_v<T, char> {
+		const auto view = grid_view(input);
+		auto grid = Grid(view.width(), view.height(), border, padding, border);
+		for (int y = 0; y < grid.h; ++y) {
+			std::memcpy(&grid.cells[grid.index(0, y)], &view(0, y), grid.w);
+		}
+		return grid;
+	}
+
+	int width() const { return w; }
+	int height() const { return h; }
+	int padding() const { return pad; }
+	int stride() const { return w + 2 * pad; }
+	size_t size() const { return static_cast<size_t>(w) * h; }
+	Vec2i dims() const { return Vec2i{w, h}; }
+
+	T* data() { return cells.data(); }
+	const T* data() const { return cells.data(); }
+
+	/**
+	 * Index of (x, y) into data() - padding included
+	 */
+	size_t index(int x, int y) const {
+		return static_cast<size_t>(y + pad) * stride() + (x + pad);
+	}
+
+	size_t index(const Vec2i& p) const { return index(p.x(), p.y()); }
+
+	/**
+	 * Position of an index into data()
+	 */
+	Vec2i pos(size_t index) const {
+		return Vec2i{static_cast<int>(index % stride()) - pad, static_cast<int>(index / stride()) - pad};
+	}
+
+	/**
+	 * Difference between the indices of a cell and its neighbour in direction dir
+	 */
+	ptrdiff_t offset(const Vec2i& dir) const {
+		return static_cast<ptrdiff_t>(dir.y()) * stride() + dir.x();
+	}
+
+	bool inbounds(int x, int y) const { return x >= 0 && y >= 0 && x < w && y < h; }
+	bool inbounds(const Vec2i& p) const { return inbounds(p.x(), p.y()); }
+
+	T& operator()(int x, int y) { return cells[index(x, y)]; }
+	const T& operator()(int x, int y) const { return cells[index(x, y)]; }
+
+	T& operator[](const Vec2i& p) { return cells[index(p)]; }
+	const T& operator[](const Vec2i& p) const { return cells[index(p)]; }
+
+	T& operator[](size_t index) { return cells[index]; }
+	const T& operator[](size_t index) const { return cells[index]; }
+
+	T& at(const Vec2i& p) { return view().at(p); }
+	const T& at(const Vec2i& p) const { return view().at(p); }
+
+	std::span<T> row(int y) { return std::span<T>(&cells[index(0, y)], w); }
+	std::span<const T> row(int y) const { return std::span<const T>(&cells[index(0, y)], w); }
+
+	void fill(const T& value) {
+		for (int y = 0; y < h; ++y) {
+			std::fill_n(cells.begin() + index(0, y), w, value);
+		}
+	}
+
+	GridView<T> view() { return GridView<T>(cells.data() + index(0, 0), w, h, 1, stride()); }
+	GridView<const T> view() const { return GridView<const T>(cells.data() + index(0, 0), w, h, 1, stride()); }
+
+	GridView<T> col(int x) { return view().col(x); }
+	GridView<const T> col(int x) const { return view().col(x); }
+
+	GridView<T> transposed() { return view().transposed(); }
+	GridView<const T> transposed() const { return view().transposed(); }
+
+	GridView<T> rotated90c() { return view().rotated90c(); }
+	GridView<const T> rotated90c() const { return view().rotated90c(); }
+
+	GridView<T> rotated90cc() { return view().rotated90cc(); }
+	GridView<const T> rotated90cc() const { return view().rotated90cc(); }
+
+	std::optional<Vec2i> find(const T& value) const { return view().find(value); }
+
+	bool operator==(const Grid& other) const {
+		if (w != other.w || h != other.h) return false;
+		for (int y = 0; y < h; ++y) {
+			if (!std::equal(row(y).begin(), row(y).end(), other.row(y).begin())) return false;
+		}
+		return true;
+	}
+
+	friend std::ostream& operator<<(std::ostream& os, const Grid& grid) {
+		return os << grid.view();
+	}
+};
+
+/**
+ * Hashes the cells without the padding (like operator==); rows of plain values are hashed as bytes
+ */
+template<typename T>
+struct std::hash<Grid<T>> {
+	size_t operator()(const Grid<T>& grid) const {
+		size_t hash = hash_pair32(static_cast<uint32_t>(grid.width()), static_cast<uint32_t>(grid.height()));
+		for (int y = 0; y < grid.height(); ++y) {
+			const auto row = grid.row(y);
+			if constexpr (std::has_unique_object_representations_v<T>) {
+				hash = static_cast<size_t>(hash_bytes(row.data(), row.size_bytes(), hash));
+			} else {
+				for (const auto& cell : row) {
+					hash = hash_combine(hash, std::hash<T>()(cell));
+				}
+			}
+		}
+		return hash;
+	}
+};
+
+#endif //GRID_H
@@ -0,0 +1,148 @@
+#include "Hash.h"
+
+#include "utils.h"
+
+#include <cstring>
+#include <random>
+#include <unordered_set>
+
+namespace {
+
+// the hashes used before hash_combine, kept for comparison
+struct XorPointHash {
+	size_t operator()(const Point& point) const {
+		return static_cast<size_t>(point.x) ^ (static_cast<size_t>(point.y) << 32);
+	}
+};
+
+struct XorVecHash {
+	size_t operator()(const Vec2i& v) const {
+		size_t hash = 0;
+		for (int i = 0; i < 2; ++i) {
+			unsigned part_hash = static_cast<size_t>(v.get(i)) << (8 * (i % 4));
+			hash ^= part_hash;
+		}
+		return hash;
+	}
+};
+
+struct XorPairHash {
+	size_t operator()(const std::pair<int, int>& pair) const {
+		return std::hash<int>()(pair.first) ^ std::hash<int>()(pair.second);
+	}
+};
+
+struct XorTupleHash {
+	size_t operator()(const std::tuple<int, int, int>& tuple) const {
+		return std::hash<int>()(std::get<0>(tuple)) ^ std::hash<int>()(std::get<1>(tuple)) ^ std::hash<int>()(std::get<2>(tuple));
+	}
+};
+
+template<typename Key, typename Hasher>
+void bench_keys(const char* name, const std::vector<Key>& keys, unsigned runs) {
+	const Hasher hasher{};
+
+	std::vector<size_t> hashes{};
+	hashes.reserve(keys.size());
+	for (const auto& key : keys) {
+		hashes.push_back(hasher(key));
+	}
+	std::sort(hashes.begin(), hashes.end());
+	const size_t distinct = std::unique(hashes.begin(), hashes.end()) - hashes.begin();
+
+	std::unordered_set<Key, Hasher> set(keys.begin(), keys.end());
+	size_t longest_chain = 0;
+	size_t shared = 0;
+	for (size_t bucket = 0; bucket < set.bucket_count(); ++bucket) {
+		const size_t size = set.bucket_size(bucket);
+		longest_chain = std::max(longest_chain, size);
+		if (size > 1) {
+			shared += size;
+		}
+	}
+
+	// million lookups per second, median over the runs
+	auto measure = [&](const std::vector<Key>& order) {
+		size_t found = 0;
+		const auto stats = time_runs(runs, [&] {
+			found = 0;
+			for (const auto& key : order) {
+				found += set.contains(key);
+			}
+		});
+		return per_second(found, stats.median) / 1e6;
+	};
+
+	// sequential order favours hashes that keep neighbouring keys in neighbouring buckets
+	std::vector<size_t> permutation(keys.size());
+	std::iota(permutation.begin(), permutation.end(), 0);
+	std::shuffle(permutation.begin(), permutation.end(), std::mt19937(42));
+	auto shuffled = keys;
+	for (size_t i = 0; i < keys.size(); ++i) {
+		shuffled[i] = keys[permutation[i]];
+	}
+
+	Logger::info("{:<24} hash collisions {:>7.3f}% | shared buckets {:>7.3f}% | longest chain {:>5} | {:>7.2f} / {:>7.2f} M lookups/s",
+		name,
+		100.0 * static_cast<double>(keys.size() - distinct) / static_cast<double>(keys.size()),
+		100.0 * static_cast<double>(shared) / static_cast<double>(keys.size()),
+		longest_chain, measure(keys), measure(shuffled));
+}
+
+}
+
+uint64_t hash_bytes(const void* data, size_t size, uint64_t seed) {
+	const auto* bytes = static_cast<const unsigned char*>(data);
+	uint64_t hash = seed ^ 0x8EBC6AF09C88C6E3ull;
+	size_t i = 0;
+	for (; i + 16 <= size; i += 16) {
+		uint64_t a, b;
+		std::memcpy(&a, bytes + i, 8);
+		std::memcpy(&b, bytes + i + 8, 8);
+		hash = hash_mum(a ^ 0xA0761D6478BD642Full, b ^ hash);
+	}
+	if (i < size) {
+		uint64_t tail[2] = {0, 0};
+		std::memcpy(tail, bytes + i, size - i);
+		hash = hash_mum(tail[0] ^ 0xA0761D6478BD642Full, tail[1] ^ hash);
+	}
+	return hash_mix(hash ^ size);
+}
+
+void bench_hash(int side, unsigned runs) {
+	Logger::init();
+
+	// centered on 0 like most infinite-grid puzzles
+	std::vector<Point> points{};
+	std::vector<std::pair<int, int>> pairs{};
+	for (int y = -side / 2; y < side - side / 2; ++y) {
+		for (int x = -side / 2; x < side - side / 2; ++x) {
+			points.push_back(Point{x, y});
+			pairs.emplace_back(x, y);
+		}
+	}
+	std::vector<Vec2i> vecs(points.size());
+	for (size_t i = 0; i < points.size(); ++i) {
+		vecs[i] = Vec2i{points[i].x, points[i].y};
+	}
+
+	const int cube = static_cast<int>(std::cbrt(static_cast<double>(side) * side));
+	std::vector<std::tuple<int, int, int>> tuples{};
+	for (int z = 0; z < cube; ++z) {
+		for (int y = 0; y < cube; ++y) {
+			for (int x = 0; x < cube; ++x) {
+				tuples.emplace_back(x, y, z);
+			}
+		}
+	}
+
+	Logger::info("{}x{} coordinates, {}^3 tuples, {} lookup run(s) each (sequential / shuffled order)", side, side, cube, runs);
+	bench_keys<Point, XorPointHash>("Point xor", points, runs);
+	bench_keys<Point, std::hash<Point>>("Point", points, runs);
+	bench_keys<Vec2i, XorVecHash>("Vec2i xor", vecs, runs);
+	bench_keys<Vec2i, std::hash<Vec2i>>("Vec2i", vecs, runs);
+	bench_keys<std::pair<int, int>, XorPairHash>("pair<int, int> xor", pairs, runs);
+	bench_keys<std::pair<int, int>, std::hash<std::pair<int, int>>>("pair<int, int>", pairs, runs);
+	bench_keys<std::tuple<int, int, int>, XorTupleHash>("tuple<int, int, int> xor", tuples, runs);
+	bench_keys<std::tuple<int, int, int>, std::hash<std::tuple<int, int, int>>>("tuple<int, int, int>", tuples, runs);
+}
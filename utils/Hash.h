@@ -0,0 +1,77 @@
+#ifndef HASH_H
+#define HASH_H
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+/* ====================================================================================================
+ * Hashing
+ */
+
+/**
+ * Multiplies a and b to 128 bit and folds the halves (the mixing step of wyhash)
+ */
+inline uint64_t hash_mum(uint64_t a, uint64_t b) {
+#if defined(__SIZEOF_INT128__)
+	const __uint128_t product = static_cast<__uint128_t>(a) * b;
+	return static_cast<uint64_t>(product) ^ static_cast<uint64_t>(product >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+	uint64_t high;
+	const uint64_t low = _umul128(a, b, &high);
+	return low ^ high;
+#else
+	const uint64_t a_lo = a & 0xFFFFFFFF, a_hi = a >> 32;
+	const uint64_t b_lo = b & 0xFFFFFFFF, b_hi = b >> 32;
+	const uint64_t lo_lo = a_lo * b_lo, hi_lo = a_hi * b_lo, lo_hi = a_lo * b_hi, hi_hi = a_hi * b_hi;
+	const uint64_t cross = (lo_lo >> 32) + (hi_lo & 0xFFFFFFFF) + lo_hi;
+	const uint64_t low = (cross << 32) | (lo_lo & 0xFFFFFFFF);
+	const uint64_t high = (hi_lo >> 32) + (cross >> 32) + hi_hi;
+	return low ^ high;
+#endif
+}
+
+/**
+ * Bijective finalizer with good avalanche (the one of xxh3): flipping an input bit changes about
+ * half of the output bits, so that dense keys like coordinates spread over the buckets
+ */
+constexpr uint64_t hash_mix(uint64_t x) {
+	x ^= x >> 37;
+	x *= 0x165667919E3779F9ull;
+	x ^= x >> 32;
+	return x;
+}
+
+/**
+ * Order dependent combination of two hashes: hash_combine(a, b) != hash_combine(b, a)
+ * and equal components do not cancel out
+ */
+inline size_t hash_combine(size_t seed, size_t value) {
+	return static_cast<size_t>(hash_mum(seed ^ 0xA0761D6478BD642Full, value ^ 0xE7037ED1A0B428DBull));
+}
+
+/**
+ * Hash of two 32-bit values; packing is collision free, the finalizer spreads the bits
+ */
+constexpr size_t hash_pair32(uint32_t a, uint32_t b) {
+	return static_cast<size_t>(hash_mix(static_cast<uint64_t>(a) | static_cast<uint64_t>(b) << 32));
+}
+
+/**
+ * Hash of size bytes at data, 16 bytes per multiply (wyhash style); for hashing whole states
+ * like grid buffers in one pass
+ */
+uint64_t hash_bytes(const void* data, size_t size, uint64_t seed = 0);
+
+/**
+ * Logs collision rates, longest bucket chains and lookup throughput of the coordinate hashes
+ * compared with the previous XOR based ones on dense coordinate sets
+ * @param side edge length of the square (and cube root of the 3D set size)
+ * @param runs lookup passes per hash
+ */
+void bench_hash(int side = 1024, unsigned runs = 5);
+
+#endif //HASH_H
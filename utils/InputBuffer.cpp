@@ -0,0 +1,167 @@
+#include "InputBuffer.h"
+
+#include "Logger.h"
+
+#include <cstring>
+#include <utility>
+
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+InputBuffer::InputBuffer(std::string contents) : length(contents.size()), owned(std::move(contents)) {}
+
+InputBuffer::InputBuffer(InputBuffer&& other) noexcept
+	: mapped_data(std::exchange(other.mapped_data, nullptr)),
+	  mapped_size(std::exchange(other.mapped_size, 0)),
+	  length(std::exchange(other.length, 0)),
+	  owned(std::move(other.owned))
+#ifdef WIN32
+	, file_handle(std::exchange(other.file_handle, nullptr)),
+	  mapping_handle(std::exchange(other.mapping_handle, nullptr))
+#endif
+{}
+
+InputBuffer& InputBuffer::operator=(InputBuffer&& other) noexcept {
+	if (this == &other) return *this;
+	unmap();
+	mapped_data = std::exchange(other.mapped_data, nullptr);
+	mapped_size = std::exchange(other.mapped_size, 0);
+	length = std::exchange(other.length, 0);
+	owned = std::move(other.owned);
+#ifdef WIN32
+	file_handle = std::exchange(other.file_handle, nullptr);
+	mapping_handle = std::exchange(other.mapping_handle, nullptr);
+#endif
+	return *this;
+}
+
+InputBuffer::~InputBuffer() {
+	unmap();
+}
+
+const std::string& InputBuffer::str() const {
+	if (mapped_data != nullptr && owned.size() != length) {
+		owned.assign(mapped_data, length);
+	}
+	return owned;
+}
+
+#ifdef WIN32
+
+InputBuffer InputBuffer::map_file(const std::filesystem::path& path) {
+	InputBuffer buffer;
+	buffer.file_handle = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+		OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (buffer.file_handle == INVALID_HANDLE_VALUE) {
+		buffer.file_handle = nullptr;
+		Logger::critical("Failed to open file '{}'", path.string());
+	}
+
+	LARGE_INTEGER file_size;
+	if (!GetFileSizeEx(buffer.file_handle, &file_size)) {
+		Logger::critical("Failed to read size of file '{}'", path.string());
+	}
+	if (file_size.QuadPart == 0) {
+		return buffer;
+	}
+
+	buffer.mapping_handle = CreateFileMappingW(buffer.file_handle, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+	if (buffer.mapping_handle == nullptr) {
+		Logger::critical("Failed to map file '{}'", path.string());
+	}
+
+	buffer.mapped_size = static_cast<size_t>(file_size.QuadPart);
+	buffer.mapped_data = static_cast<char*>(MapViewOfFile(buffer.mapping_handle, FILE_MAP_COPY, 0, 0, buffer.mapped_size));
+	if (buffer.mapped_data == nullptr) {
+		Logger::critical("Failed to map file '{}'", path.string());
+	}
+
+	buffer.length = normalize_newlines(buffer.mapped_data, buffer.mapped_size);
+	return buffer;
+}
+
+void InputBuffer::unmap() {
+	if (mapped_data != nullptr) UnmapViewOfFile(mapped_data);
+	if (mapping_handle != nullptr) CloseHandle(mapping_handle);
+	if (file_handle != nullptr) CloseHandle(file_handle);
+	mapped_data = nullptr;
+	mapping_handle = nullptr;
+	file_handle = nullptr;
+	mapped_size = 0;
+}
+
+#else
+
+InputBuffer InputBuffer::map_file(const std::filesystem::path& path) {
+	InputBuffer buffer;
+	const int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0) {
+		Logger::critical("Failed to open file '{}'", path.string());
+	}
+
+	struct stat file_stat{};
+	if (fstat(fd, &file_stat) != 0) {
+		close(fd);
+		Logger::critical("Failed to read size of file '{}'", path.string());
+	}
+	if (file_stat.st_size == 0) {
+		close(fd);
+		return buffer;
+	}
+
+	// private mapping: the in-place CRLF pass copies only the pages it writes to
+	const size_t size = static_cast<size_t>(file_stat.st_size);
+	void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (data == MAP_FAILED) {
+		Logger::critical("Failed to map file '{}'", path.string());
+	}
+	madvise(data, size, MADV_SEQUENTIAL);
+
+	buffer.mapped_data = static_cast<char*>(data);
+	buffer.mapped_size = size;
+	buffer.length = normalize_newlines(buffer.mapped_data, size);
+	return buffer;
+}
+
+void InputBuffer::unmap() {
+	if (mapped_data != nullptr) {
+		munmap(mapped_data, mapped_size);
+	}
+	mapped_data = nullptr;
+	mapped_size = 0;
+}
+
+#endif
+
+size_t normalize_newlines(char* data, size_t size) {
+	char* end = data + size;
+	char* cr = static_cast<char*>(std::memchr(data, '\r', size));
+	if (cr == nullptr) {
+		return size;
+	}
+
+	// everything before the first '\r' stays where it is
+	char* write = cr;
+	char* read = cr;
+	while (read != end) {
+		char* next_cr = static_cast<char*>(std::memchr(read + 1, '\r', end - read - 1));
+		char* segment_end = next_cr != nullptr ? next_cr : end;
+
+		// drop the '\r' only if it is followed by '\n'
+		const bool crlf = read + 1 != end && read[1] == '\n';
+		char* segment_start = crlf ? read + 1 : read;
+		const size_t segment_len = segment_end - segment_start;
+		std::memmove(write, segment_start, segment_len);
+		write += segment_len;
+		read = segment_end;
+	}
+
+	return write - data;
+}
@@ -0,0 +1,69 @@
+#ifndef INPUTBUFFER_H
+#define INPUTBUFFER_H
+
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+/**
+ * Read-only puzzle input that is either memory-mapped from a file or owns a string.
+ * Files are mapped copy-on-write, so normalising CRLF line endings only touches the
+ * pages that actually contain a '\r'. Move-only.
+ */
+class InputBuffer {
+private:
+	char* mapped_data = nullptr;
+	size_t mapped_size = 0;
+	size_t length = 0;
+	mutable std::string owned;
+
+#ifdef WIN32
+	void* file_handle = nullptr;
+	void* mapping_handle = nullptr;
+#endif
+
+public:
+	InputBuffer() = default;
+	explicit InputBuffer(std::string contents);
+
+	InputBuffer(const InputBuffer&) = delete;
+	InputBuffer& operator=(const InputBuffer&) = delete;
+
+	InputBuffer(InputBuffer&& other) noexcept;
+	InputBuffer& operator=(InputBuffer&& other) noexcept;
+
+	~InputBuffer();
+
+	/**
+	 * Maps a file into memory and converts "\r\n" to "\n" in a single in-place pass
+	 * @param path file to be mapped
+	 * @return buffer viewing the file contents
+	 * @throws 0xDEAD If file could not be opened or mapped
+	 */
+	static InputBuffer map_file(const std::filesystem::path& path);
+
+	const char* data() const { return mapped_data != nullptr ? mapped_data : owned.data(); }
+	size_t size() const { return length; }
+	bool empty() const { return length == 0; }
+
+	std::string_view view() const { return {data(), length}; }
+	operator std::string_view() const { return view(); }
+
+	/**
+	 * Contents as std::string. Mapped buffers copy their contents once on the first call.
+	 */
+	const std::string& str() const;
+
+private:
+	void unmap();
+};
+
+/**
+ * Replaces every "\r\n" with "\n" in place
+ * @param data characters to be normalised
+ * @param size number of characters
+ * @return new number of characters
+ */
+size_t normalize_newlines(char* data, size_t size);
+
+#endif //INPUTBUFFER_H
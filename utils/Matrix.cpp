@@ -0,0 +1,235 @@
+#include "Matrix.h"
+
+#include "utils.h"
+
+#include <random>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define MATRIX_X86
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#define MATRIX_TARGET_AVX2
+#else
+#define MATRIX_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+static_assert(sizeof(Vec2i) == 2 * sizeof(int), "Vec2i batches are processed as plain int arrays");
+
+namespace {
+
+// count is the number of ints; starts at begin so the SIMD kernels can hand over their tail
+void add_ints_scalar(const int* a, const int* b, int* out, size_t begin, size_t count) {
+	for (size_t i = begin; i < count; ++i) {
+		out[i] = a[i] + b[i];
+	}
+}
+
+// p holds (x, y) pairs, so (dx, dy) is added alternately; begin must be even
+void translate_ints_scalar(int* p, int dx, int dy, size_t begin, size_t count) {
+	for (size_t i = begin; i < count; i += 2) {
+		p[i] += dx;
+		p[i + 1] += dy;
+	}
+}
+
+#ifdef MATRIX_X86
+
+void add_ints_sse2(const int* a, const int* b, int* out, size_t count) {
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4) {
+		const __m128i sum = _mm_add_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)),
+			_mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i)));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), sum);
+	}
+	add_ints_scalar(a, b, out, i, count);
+}
+
+MATRIX_TARGET_AVX2
+void add_ints_avx2(const int* a, const int* b, int* out, size_t count) {
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8) {
+		const __m256i sum = _mm256_add_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i)),
+			_mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i)));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), sum);
+	}
+	add_ints_scalar(a, b, out, i, count);
+}
+
+void translate_ints_sse2(int* p, int dx, int dy, size_t count) {
+	const __m128i delta = _mm_setr_epi32(dx, dy, dx, dy);
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4) {
+		auto* chunk = reinterpret_cast<__m128i*>(p + i);
+		_mm_storeu_si128(chunk, _mm_add_epi32(_mm_loadu_si128(chunk), delta));
+	}
+	translate_ints_scalar(p, dx, dy, i, count);
+}
+
+MATRIX_TARGET_AVX2
+void translate_ints_avx2(int* p, int dx, int dy, size_t count) {
+	const __m256i delta = _mm256_setr_epi32(dx, dy, dx, dy, dx, dy, dx, dy);
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8) {
+		auto* chunk = reinterpret_cast<__m256i*>(p + i);
+		_mm256_storeu_si256(chunk, _mm256_add_epi32(_mm256_loadu_si256(chunk), delta));
+	}
+	translate_ints_scalar(p, dx, dy, i, count);
+}
+
+#endif
+
+}
+
+void translate_all(std::span<Vec2i> points, const Vec2i& delta) {
+	if (points.empty()) return;
+	int* p = &points.front().x();
+	const size_t count = points.size() * 2;
+#ifdef MATRIX_X86
+	if (scan_level() == ScanLevel::AVX2) {
+		translate_ints_avx2(p, delta.x(), delta.y(), count);
+	} else {
+		translate_ints_sse2(p, delta.x(), delta.y(), count);
+	}
+#else
+	translate_ints_scalar(p, delta.x(), delta.y(), 0, count);
+#endif
+}
+
+void add_all(std::span<const Vec2i> a, std::span<const Vec2i> b, std::span<Vec2i> out) {
+	const size_t size = std::min(a.size(), b.size());
+	if (size == 0) return;
+	if (out.size() < size) {
+		Logger::critical("add_all: output holds {} points, needs {}", out.size(), size);
+	}
+	const int* pa = a.front().getValuePtr();
+	const int* pb = b.front().getValuePtr();
+	int* po = &out.front().x();
+#ifdef MATRIX_X86
+	if (scan_level() == ScanLevel::AVX2) {
+		add_ints_avx2(pa, pb, po, size * 2);
+	} else {
+		add_ints_sse2(pa, pb, po, size * 2);
+	}
+#else
+	add_ints_scalar(pa, pb, po, 0, size * 2);
+#endif
+}
+
+namespace {
+
+// the element loops the Matrix operators used before the matrix_simd kernels, kept for comparison
+template<int M, int N, typename T>
+Matrix<M, N, T> generic_add(const Matrix<M, N, T>& a, const Matrix<M, N, T>& b) {
+	auto result = Matrix<M, N, T>();
+	for (int i = 0; i < M * N; i++) {
+		result.set(i, a.get(i) + b.get(i));
+	}
+	return result;
+}
+
+template<int M, int N, typename T>
+Matrix<M, N, T> generic_scale(const Matrix<M, N, T>& a, T s) {
+	auto result = Matrix<M, N, T>();
+	for (int i = 0; i < M * N; i++) {
+		result.set(i, a.get(i) * s);
+	}
+	return result;
+}
+
+template<int M, int N, int L, typename T>
+Matrix<M, L, T> generic_product(const Matrix<M, N, T>& a, const Matrix<N, L, T>& b) {
+	auto result = Matrix<M, L, T>();
+	for (int i = 0; i < M; i++) {
+		for (int j = 0; j < L; j++) {
+			T sum = (T)0;
+			for (int k = 0; k < N; k++) {
+				sum += (T)(a.get(i, k) * b.get(k, j));
+			}
+			result.set(i, j, sum);
+		}
+	}
+	return result;
+}
+
+float generic_dot(const Vec4& a, const Vec4& b) {
+	float sum = 0.f;
+	for (int i = 0; i < 4; i++) {
+		sum += a.get(i) * b.get(i);
+	}
+	return sum;
+}
+
+/**
+ * Million operations per second of fn (which processes n elements), median over the runs
+ */
+template<typename Fn>
+double measure(size_t n, unsigned runs, Fn&& fn) {
+	return per_second(n, time_runs(runs, fn).median) / 1e6;
+}
+
+void log_comparison(const char* name, double generic, double simd) {
+	Logger::info("{:<22} generic {:>8.1f} | simd {:>8.1f} M ops/s ({:.2f}x)", name, generic, simd, simd / generic);
+}
+
+}
+
+void bench_matrix(size_t n, unsigned runs) {
+	Logger::init();
+	std::mt19937 rng(42);
+	std::uniform_real_distribution<float> real(-1.f, 1.f);
+	std::uniform_int_distribution<int> integer(-1000, 1000);
+
+	// vectors of Matrix are sized up front and filled by index
+	std::vector<Vec4> va(n), vb(n), vout(n);
+	std::vector<Vec4i> ia(n), ib(n), iout(n);
+	std::vector<Mat4> ma(n), mb(n), mout(n);
+	std::vector<Vec2i> points(n * 4), offsets(n * 4), pout(n * 4);
+	for (size_t k = 0; k < n; ++k) {
+		va[k] = Vec4(real(rng), real(rng), real(rng), real(rng));
+		vb[k] = Vec4(real(rng), real(rng), real(rng), real(rng));
+		ia[k] = Vec4i(integer(rng), integer(rng), integer(rng), integer(rng));
+		ib[k] = Vec4i(integer(rng), integer(rng), integer(rng), integer(rng));
+		for (int i = 0; i < 16; ++i) {
+			ma[k].set(i, real(rng));
+			mb[k].set(i, real(rng));
+		}
+	}
+	for (size_t k = 0; k < points.size(); ++k) {
+		points[k] = Vec2i(integer(rng), integer(rng));
+		offsets[k] = Vec2i(integer(rng), integer(rng));
+	}
+
+	volatile float float_sink = 0.f;
+	Logger::info("{} elements per pass, {} run(s) each", n, runs);
+
+	log_comparison("Vec4 + Vec4",
+		measure(n, runs, [&] { for (size_t k = 0; k < n; ++k) vout[k] = generic_add(va[k], vb[k]); }),
+		measure(n, runs, [&] { for (size_t k = 0; k < n; ++k) vout[k] = va[k] + vb[k]; }));
+	log_comparison("Vec4 * float",
+		measure(n, runs, [&] { for (size_t k = 0; k < n; ++k) vout[k] = generic_scale(va[k], 1.5f); }),
+		measure(n, runs, [&] { for (size_t k = 0; k < n; ++k) vout[k] = va[k] * 1.5f; }));
+	log_comparison("Vec4.dot",
+		measure(n, runs, [&] { float sum = 0.f; for (size_t k = 0; k < n; ++k) sum += generic_dot(va[k], vb[k]); float_sink = sum; }),
+		measure(n, runs, [&] { float sum = 0.f; for (size_t k = 0; k < n; ++k) sum += va[k].dot(vb[k]); float_sink = sum; }));
+	log_comparison("Vec4i + Vec4i",
+		measure(n, runs, [&] { for (size_t k = 0; k < n; ++k) iout[k] = generic_add(ia[k], ib[k]); }),
+		measure(n, runs, [&] { for (size_t k = 0; k < n; ++k) iout[k] = ia[k] + ib[k]; }));
+	log_comparison("Vec4i * int",
+		measure(n, runs, [&] { for (size_t k = 0; k < n; ++k) iout[k] = generic_scale(ia[k], 3); }),
+		measure(n, runs, [&] { for (size_t k = 0; k < n; ++k) iout[k] = ia[k] * 3; }));
+	log_comparison("Mat4 * Mat4",
+		measure(n, runs, [&] { for (size_t k = 0; k < n; ++k) mout[k] = generic_product(ma[k], mb[k]); }),
+		measure(n, runs, [&] { for (size_t k = 0; k < n; ++k) mout[k] = ma[k] * mb[k]; }));
+	log_comparison("Mat4 * Vec4",
+		measure(n, runs, [&] { for (size_t k = 0; k < n; ++k) vout[k] = generic_product(ma[k], va[k]); }),
+		measure(n, runs, [&] { for (size_t k = 0; k < n; ++k) vout[k] = ma[k] * va[k]; }));
+
+	const Vec2i delta(3, -2);
+	log_comparison("Vec2i batch translate",
+		measure(points.size(), runs, [&] { for (auto& p : points) p += delta; }),
+		measure(points.size(), runs, [&] { translate_all(points, delta); }));
+	log_comparison("Vec2i batch add",
+		measure(points.size(), runs, [&] { for (size_t k = 0; k < points.size(); ++k) pout[k] = points[k] + offsets[k]; }),
+		measure(points.size(), runs, [&] { add_all(points, offsets, pout); }));
+}
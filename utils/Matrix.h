@@ -6,6 +6,143 @@
 #include <iostream>
 #include <limits>
 #include <cassert>
+#include <cstring>
+#include <algorithm>
+#include <optional>
+#include <span>
+
+#include "Hash.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MATRIX_SSE2
+#include <emmintrin.h>
+#if defined(__SSE4_1__)
+#include <smmintrin.h>
+#endif
+#endif
+
+/* ====================================================================================================
+ * SIMD kernels for matrices of 4 floats or ints (Vec4, Vec4i, Mat2, ...) and 4x4 products.
+ * Without SSE2 they are plain loops, so callers need no #ifdef.
+ */
+
+namespace matrix_simd {
+
+#ifdef MATRIX_SSE2
+
+inline __m128 load(const float* p) { return _mm_loadu_ps(p); }
+inline __m128i load(const int* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+inline void store(float* p, __m128 v) { _mm_storeu_ps(p, v); }
+inline void store(int* p, __m128i v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+inline __m128 broadcast(float s) { return _mm_set1_ps(s); }
+inline __m128i broadcast(int s) { return _mm_set1_epi32(s); }
+inline __m128 add(__m128 a, __m128 b) { return _mm_add_ps(a, b); }
+inline __m128i add(__m128i a, __m128i b) { return _mm_add_epi32(a, b); }
+inline __m128 sub(__m128 a, __m128 b) { return _mm_sub_ps(a, b); }
+inline __m128i sub(__m128i a, __m128i b) { return _mm_sub_epi32(a, b); }
+inline __m128 mul(__m128 a, __m128 b) { return _mm_mul_ps(a, b); }
+
+inline __m128i mul(__m128i a, __m128i b) {
+#ifdef __SSE4_1__
+	return _mm_mullo_epi32(a, b);
+#else
+	// SSE2 only multiplies lanes 0 and 2 (to 64 bit): do even and odd lanes separately and interleave the low halves
+	const __m128i even = _mm_mul_epu32(a, b);
+	const __m128i odd = _mm_mul_epu32(_mm_srli_si128(a, 4), _mm_srli_si128(b, 4));
+	return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+#endif
+}
+
+template<typename T>
+inline void add4(const T* a, const T* b, T* out) { store(out, add(load(a), load(b))); }
+template<typename T>
+inline void sub4(const T* a, const T* b, T* out) { store(out, sub(load(a), load(b))); }
+template<typename T>
+inline void mul4(const T* a, const T* b, T* out) { store(out, mul(load(a), load(b))); }
+template<typename T>
+inline void add4(const T* a, T s, T* out) { store(out, add(load(a), broadcast(s))); }
+template<typename T>
+inline void sub4(const T* a, T s, T* out) { store(out, sub(load(a), broadcast(s))); }
+template<typename T>
+inline void mul4(const T* a, T s, T* out) { store(out, mul(load(a), broadcast(s))); }
+template<typename T>
+inline void neg4(const T* a, T* out) { store(out, sub(broadcast(T{0}), load(a))); }
+
+/**
+ * Pairwise sum ((a0 b0 + a1 b1) + (a2 b2 + a3 b3)), may differ from a sequential sum in the last bit
+ */
+inline float dot4(const float* a, const float* b) {
+	const __m128 products = _mm_mul_ps(load(a), load(b));
+	const __m128 pairs = _mm_add_ps(products, _mm_shuffle_ps(products, products, _MM_SHUFFLE(2, 3, 0, 1)));
+	return _mm_cvtss_f32(_mm_add_ss(pairs, _mm_movehl_ps(pairs, pairs)));
+}
+
+/**
+ * out = a * b for row-major 4x4 matrices: every output row is a combination of the rows of b
+ * (same summation order as the scalar product)
+ */
+template<typename T>
+inline void mat4_mul(const T* a, const T* b, T* out) {
+	const auto b0 = load(b), b1 = load(b + 4), b2 = load(b + 8), b3 = load(b + 12);
+	for (int i = 0; i < 4; ++i) {
+		auto row = mul(broadcast(a[4 * i]), b0);
+		row = add(row, mul(broadcast(a[4 * i + 1]), b1));
+		row = add(row, mul(broadcast(a[4 * i + 2]), b2));
+		row = add(row, mul(broadcast(a[4 * i + 3]), b3));
+		store(out + 4 * i, row);
+	}
+}
+
+/**
+ * out = a * v for a row-major 4x4 matrix a and a column vector v
+ */
+inline void mat4_vec(const float* a, const float* v, float* out) {
+	__m128 r0 = load(a), r1 = load(a + 4), r2 = load(a + 8), r3 = load(a + 12);
+	_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+	auto result = mul(r0, broadcast(v[0]));
+	result = add(result, mul(r1, broadcast(v[1])));
+	result = add(result, mul(r2, broadcast(v[2])));
+	result = add(result, mul(r3, broadcast(v[3])));
+	store(out, result);
+}
+
+#else
+
+template<typename T>
+inline void add4(const T* a, const T* b, T* out) { for (int i = 0; i < 4; ++i) out[i] = a[i] + b[i]; }
+template<typename T>
+inline void sub4(const T* a, const T* b, T* out) { for (int i = 0; i < 4; ++i) out[i] = a[i] - b[i]; }
+template<typename T>
+inline void mul4(const T* a, const T* b, T* out) { for (int i = 0; i < 4; ++i) out[i] = a[i] * b[i]; }
+template<typename T>
+inline void add4(const T* a, T s, T* out) { for (int i = 0; i < 4; ++i) out[i] = a[i] + s; }
+template<typename T>
+inline void sub4(const T* a, T s, T* out) { for (int i = 0; i < 4; ++i) out[i] = a[i] - s; }
+template<typename T>
+inline void mul4(const T* a, T s, T* out) { for (int i = 0; i < 4; ++i) out[i] = a[i] * s; }
+template<typename T>
+inline void neg4(const T* a, T* out) { for (int i = 0; i < 4; ++i) out[i] = -a[i]; }
+
+inline float dot4(const float* a, const float* b) { return (a[0] * b[0] + a[1] * b[1]) + (a[2] * b[2] + a[3] * b[3]); }
+
+template<typename T>
+inline void mat4_mul(const T* a, const T* b, T* out) {
+	for (int i = 0; i < 4; ++i) {
+		for (int j = 0; j < 4; ++j) {
+			out[4 * i + j] = a[4 * i] * b[j] + a[4 * i + 1] * b[4 + j] + a[4 * i + 2] * b[8 + j] + a[4 * i + 3] * b[12 + j];
+		}
+	}
+}
+
+inline void mat4_vec(const float* a, const float* v, float* out) {
+	for (int i = 0; i < 4; ++i) {
+		out[i] = a[4 * i] * v[0] + a[4 * i + 1] * v[1] + a[4 * i + 2] * v[2] + a[4 * i + 3] * v[3];
+	}
+}
+
+#endif
+
+}
 
 #define MAT_TEMPLATE template<typename U> requires supports_arithmetics<U, T> && std::is_convertible_v<U, T>
 
@@ -30,8 +167,19 @@ public:
 	typedef Matrix<M, N, T> Type;
 
 private:
+	template<int, int, typename>
+	friend class Matrix;
+
 	T data[M * N];
 
+	/** element types with matrix_simd kernels (when the other operand has the same type) */
+	template<typename U>
+	static constexpr bool simd_elements = std::is_same_v<T, U> && (std::is_same_v<T, float> || std::is_same_v<T, int>);
+
+	/** element-wise operations that fit one SSE register */
+	template<typename U>
+	static constexpr bool simd4 = M * N == 4 && simd_elements<U>;
+
 public:
 	Matrix() : data{static_cast<T>(0)} {}
 
@@ -97,6 +245,10 @@ public:
 
 	MAT_TEMPLATE
 	Type& operator+=(U const& s) {
+		if constexpr (simd4<U>) {
+			matrix_simd::add4(data, s, data);
+			return *this;
+		}
 		for (int i = 0; i < M * N; ++i) {
 			data[i] += s;
 		}
@@ -105,6 +257,10 @@ public:
 
 	MAT_TEMPLATE
 	Type& operator+=(Matrix<M, N, U> const& m) {
+		if constexpr (simd4<U>) {
+			matrix_simd::add4(data, m.data, data);
+			return *this;
+		}
 		for (int i = 0; i < M * N; ++i) {
 			data[i] += m.get(i);
 		}
@@ -113,6 +269,10 @@ public:
 
 	MAT_TEMPLATE
 	Type& operator-=(U const& s) {
+		if constexpr (simd4<U>) {
+			matrix_simd::sub4(data, s, data);
+			return *this;
+		}
 		for (int i = 0; i < M * N; ++i) {
 			data[i] -= s;
 		}
@@ -121,6 +281,10 @@ public:
 
 	MAT_TEMPLATE
 	Type& operator-=(Matrix<M, N, U> const& m) {
+		if constexpr (simd4<U>) {
+			matrix_simd::sub4(data, m.data, data);
+			return *this;
+		}
 		for (int i = 0; i < M * N; ++i) {
 			data[i] -= m.get(i);
 		}
@@ -129,6 +293,10 @@ public:
 
 	MAT_TEMPLATE
 	Type& operator*=(U const& s) {
+		if constexpr (simd4<U>) {
+			matrix_simd::mul4(data, s, data);
+			return *this;
+		}
 		for (int i = 0; i < M * N; ++i) {
 			data[i] *= s;
 		}
@@ -137,6 +305,10 @@ public:
 
 	MAT_TEMPLATE
 	Type& operator*=(Matrix<M, N, U> const& m) {
+		if constexpr (simd4<U>) {
+			matrix_simd::mul4(data, m.data, data);
+			return *this;
+		}
 		for (int i = 0; i < M * N; ++i) {
 			data[i] *= m.get(i);
 		}
@@ -161,6 +333,10 @@ public:
 
 	Type operator-() const {
 		auto result = Type();
+		if constexpr (simd4<T>) {
+			matrix_simd::neg4(data, result.data);
+			return result;
+		}
 		for (int i = 0; i < M * N; ++i) {
 			result.set(i, -get(i));
 		}
@@ -170,6 +346,10 @@ public:
 	MAT_TEMPLATE
 	Type operator +(Matrix<M, N, U> const& m) const {
 		auto result = Type();
+		if constexpr (simd4<U>) {
+			matrix_simd::add4(data, m.data, result.data);
+			return result;
+		}
 		for (int i = 0; i < M*N; i++) {
 			result.set(i, get(i) + m.get(i));
 		}
@@ -179,6 +359,10 @@ public:
 	MAT_TEMPLATE
 	friend Type operator +(Type const& m, U const& s) {
 		auto result = Type();
+		if constexpr (simd4<U>) {
+			matrix_simd::add4(m.data, s, result.data);
+			return result;
+		}
 		for (int i = 0; i < M*N; i++) {
 			result.set(i, m.get(i) + s);
 		}
@@ -193,6 +377,10 @@ public:
 	MAT_TEMPLATE
 	Type operator -(Matrix<M, N, U> const& m) const {
 		auto result = Type();
+		if constexpr (simd4<U>) {
+			matrix_simd::sub4(data, m.data, result.data);
+			return result;
+		}
 		for (int i = 0; i < M*N; i++) {
 			result.set(i, get(i) - m.get(i));
 		}
@@ -202,6 +390,10 @@ public:
 	MAT_TEMPLATE
 	friend Type operator -(Type const& m, U const& s) {
 		auto result = Type();
+		if constexpr (simd4<U>) {
+			matrix_simd::sub4(m.data, s, result.data);
+			return result;
+		}
 		for (int i = 0; i < M*N; i++) {
 			result.set(i, m.get(i) - s);
 		}
@@ -220,6 +412,10 @@ public:
 	MAT_TEMPLATE
 	friend Type operator *(Type const& m, U const& s) {
 		auto result = Type();
+		if constexpr (simd4<U>) {
+			matrix_simd::mul4(m.data, s, result.data);
+			return result;
+		}
 		for (int i = 0; i < M*N; i++) {
 			result.set(i, m.get(i) * s);
 		}
@@ -229,6 +425,10 @@ public:
 	MAT_TEMPLATE
 	friend Type operator *(U const& s, Type const& m) {
 		auto result = Type();
+		if constexpr (simd4<U>) {
+			matrix_simd::mul4(m.data, s, result.data);
+			return result;
+		}
 		for (int i = 0; i < M*N; i++) {
 			result.set(i, s * m.get(i));
 		}
@@ -238,6 +438,13 @@ public:
 	template<int L, typename U> requires (std::is_convertible_v<U, T>)
 	Matrix<M, L, T> operator *(Matrix<N, L, U> const& m) const {
 		auto result = Matrix<M, L, T>();
+		if constexpr (M == 4 && N == 4 && L == 4 && simd_elements<U>) {
+			matrix_simd::mat4_mul(data, m.data, result.data);
+			return result;
+		} else if constexpr (M == 4 && N == 4 && L == 1 && std::is_same_v<T, float> && std::is_same_v<U, float>) {
+			matrix_simd::mat4_vec(data, m.data, result.data);
+			return result;
+		}
 		for (int i = 0; i < M; i++) {
 			for (int j = 0; j < L; j++) {
 				T sum = (T)0;
@@ -286,6 +493,9 @@ public:
 	}
 
 	float dot(const Matrix<M, 1, T>& m) const requires (N == 1) {
+		if constexpr (M == 4 && std::is_same_v<T, float>) {
+			return matrix_simd::dot4(data, m.data);
+		}
 		float sum = 0.f;
 		for (int i = 0; i < M; i++) {
 			sum += get(i) * m.get(i);
@@ -315,15 +525,53 @@ public:
 			- (get(2) * get(4) * get(6) + get(1) * get(3) * get(8) + get(0) * get(5) * get(7));
 	}
 
+	/**
+	 * Partial-pivot LU for floating T, fraction-free Bareiss elimination (exact) otherwise; O(n^3)
+	 */
 	T det() const requires (M == N && M > 3) {
-		auto cut = cutRow(0);
-		bool negative = false;
-		T sum = (T)0;
-		for (int i = 0; i < N; i++) {
-			sum += (1 - 2 * negative) * cut.cutCol(i).det() * get(i);
-			negative = !negative;
+		T a[M * N];
+		std::copy(data, data + M * N, a);
+		return eliminate<N>(a);
+	}
+
+	/**
+	 * Empty if the matrix is singular or, for integral T, if the inverse is not integral
+	 */
+	std::optional<Type> inverse() const requires (M == N) {
+		T a[M * 2 * N];
+		for (int i = 0; i < M; i++) {
+			for (int j = 0; j < N; j++) {
+				a[i * 2 * N + j] = get(i, j);
+				a[i * 2 * N + N + j] = static_cast<T>(i == j);
+			}
 		}
-		return sum;
+		auto result = Type();
+		if (!back_substitute<2 * N>(a, eliminate<2 * N>(a), result.data)) {
+			return std::nullopt;
+		}
+		return result;
+	}
+
+	/**
+	 * Solution x of (*this) * x = b; empty if the matrix is singular or, for integral T, if x is not integral
+	 */
+	std::optional<ColType> solve(ColType const& b) const requires (M == N) {
+		T a[M * (N + 1)];
+		for (int i = 0; i < M; i++) {
+			for (int j = 0; j < N; j++) {
+				a[i * (N + 1) + j] = get(i, j);
+			}
+			a[i * (N + 1) + N] = b.get(i);
+		}
+		T x[M];
+		if (!back_substitute<N + 1>(a, eliminate<N + 1>(a), x)) {
+			return std::nullopt;
+		}
+		auto result = ColType();
+		for (int i = 0; i < M; i++) {
+			result.set(i, x[i]);
+		}
+		return result;
 	}
 
 	Type normalized() const requires (N == 1) {
@@ -345,6 +593,19 @@ public:
 		return result;
 	}
 
+	/**
+	 * this^k by binary exponentiation, O(M^3 log k); with T = ModInt<P> for linear recurrences mod P
+	 */
+	Type pow(uint64_t k) const requires (M == N) {
+		auto result = Type::identity();
+		auto base = Type(*this);
+		for (; k > 0; k >>= 1) {
+			if (k & 1) result = result * base;
+			if (k > 1) base = base * base;
+		}
+		return result;
+	}
+
 	static Matrix<4, 4, T> lookAt(Matrix<3, 1, T> const& camera_pos, Matrix<3, 1, T> const& camera_dir, Matrix<3, 1, T> const& up) {
 		Matrix<3, 1, T> const f((camera_dir - camera_pos).normalized());
 		Matrix<3, 1, T> const s(f.cross(up).normalized());
@@ -455,6 +716,120 @@ public:
 		return m;
 	}
 
+private:
+	/**
+	 * Brings the row-major M x C matrix a (square part in the first N columns, right-hand sides
+	 * after it) to upper triangular form and returns the determinant of the square part.
+	 * Floating T pivots on the largest magnitude; all other T (integers or exact number types)
+	 * use Bareiss' fraction-free elimination, where every division is exact and the last pivot
+	 * is the determinant.
+	 */
+	template<int C>
+	static T eliminate(T* a) requires (M == N) {
+		T sign = static_cast<T>(1);
+		T previous = static_cast<T>(1);
+		// floating pivots below a few ulps of the largest entry (growing during the elimination)
+		// per step are rounding noise of a singular matrix
+		T largest = static_cast<T>(0);
+		if constexpr (std::is_floating_point_v<T>) {
+			for (int i = 0; i < M * N; i++) {
+				largest = std::max(largest, static_cast<T>(std::abs(a[(i / N) * C + i % N])));
+			}
+		}
+		for (int k = 0; k < N; k++) {
+			int pivot = k;
+			for (int i = k + 1; i < M; i++) {
+				if constexpr (!std::is_floating_point_v<T>) {
+					if (a[pivot * C + k] != static_cast<T>(0)) break;
+					pivot = i;
+				} else if (std::abs(a[i * C + k]) > std::abs(a[pivot * C + k])) {
+					pivot = i;
+				}
+			}
+			if constexpr (std::is_floating_point_v<T>) {
+				if (std::abs(a[pivot * C + k]) <= 16 * N * std::numeric_limits<T>::epsilon() * largest) {
+					return static_cast<T>(0);
+				}
+			} else if (a[pivot * C + k] == static_cast<T>(0)) {
+				return static_cast<T>(0);
+			}
+			if (pivot != k) {
+				std::swap_ranges(a + pivot * C, a + (pivot + 1) * C, a + k * C);
+				sign = -sign;
+			}
+
+			const T p = a[k * C + k];
+			for (int i = k + 1; i < M; i++) {
+				const T factor = a[i * C + k];
+				if constexpr (!std::is_floating_point_v<T>) {
+					for (int j = k + 1; j < C; j++) {
+						a[i * C + j] = (a[i * C + j] * p - factor * a[k * C + j]) / previous;
+					}
+				} else {
+					const T scale = factor / p;
+					for (int j = k + 1; j < C; j++) {
+						a[i * C + j] -= scale * a[k * C + j];
+					}
+					for (int j = k + 1; j < N; j++) {
+						largest = std::max(largest, static_cast<T>(std::abs(a[i * C + j])));
+					}
+				}
+				a[i * C + k] = static_cast<T>(0);
+			}
+			previous = p;
+		}
+
+		if constexpr (!std::is_floating_point_v<T>) {
+			return sign * a[(N - 1) * C + N - 1];
+		} else {
+			T det = sign;
+			for (int k = 0; k < N; k++) {
+				det *= a[k * C + k];
+			}
+			return det;
+		}
+	}
+
+	/**
+	 * Solves the triangular system left by eliminate() for every right-hand side column; x is
+	 * row-major N x (C - N). For integral T the values d * x (d = last pivot) are integers by
+	 * Cramer's rule, so the substitution runs on those and divides by d at the end.
+	 */
+	template<int C>
+	static bool back_substitute(const T* a, T det, T* x) requires (M == N) {
+		constexpr int K = C - N;
+		if (det == static_cast<T>(0)) {
+			return false;
+		}
+		const T d = a[(N - 1) * C + N - 1];
+		for (int r = 0; r < K; r++) {
+			for (int i = N - 1; i >= 0; i--) {
+				T sum = a[i * C + N + r];
+				if constexpr (std::numeric_limits<T>::is_integer) {
+					sum *= d;
+				}
+				for (int j = i + 1; j < N; j++) {
+					sum -= a[i * C + j] * x[j * K + r];
+				}
+				x[i * K + r] = sum / a[i * C + i];
+			}
+			if constexpr (std::numeric_limits<T>::is_integer) {
+				for (int i = 0; i < N; i++) {
+					if (x[i * K + r] % d != 0) {
+						return false;
+					}
+				}
+			}
+		}
+		if constexpr (std::numeric_limits<T>::is_integer) {
+			for (int i = 0; i < N * K; i++) {
+				x[i] /= d;
+			}
+		}
+		return true;
+	}
+
+public:
 	friend std::ostream& operator <<(std::ostream& os, Type const& m) {
 		os << '{';
 		for (int i = 0; i < M; i++) {
@@ -484,18 +859,36 @@ typedef Matrix<2, 2, float> Mat2;
 typedef Matrix<3, 3, float> Mat3;
 typedef Matrix<4, 4, float> Mat4;
 
+/**
+ * points[i] += delta; 4 (AVX2, see scan_level()) or 2 (SSE2) points per instruction
+ */
+void translate_all(std::span<Vec2i> points, const Vec2i& delta);
+
+/**
+ * out[i] = a[i] + b[i]; out has to be at least as long as a and b
+ */
+void add_all(std::span<const Vec2i> a, std::span<const Vec2i> b, std::span<Vec2i> out);
+
+/**
+ * Logs the throughput of the SIMD paths (Vec4/Vec4i arithmetic, Vec4 dot, Mat4 products, Vec2i
+ * batches) against element-by-element loops like the generic Matrix operators
+ * @param n number of vectors / matrices per pass
+ * @param runs timed passes per kernel (median is reported)
+ */
+void bench_matrix(size_t n = 1 << 16, unsigned runs = 5);
+
 template <int M, int N>
 struct std::hash<Matrix<M, N, int>> {
 	size_t operator()(Matrix<M, N, int> const& m) const {
-		size_t hash = 0;
-		for (int i = 0; i < M * N; ++i) {
-			unsigned part_hash = static_cast<size_t>(m.get(i)) << (8 * (i % 4));
-			if (i % 8 < 4)
-				hash ^= part_hash;
-			else
-				hash ^= std::byteswap(hash);
+		if constexpr (M * N == 2) {
+			return hash_pair32(static_cast<uint32_t>(m.get(0)), static_cast<uint32_t>(m.get(1)));
+		} else {
+			size_t hash = 0;
+			for (int i = 0; i < M * N; ++i) {
+				hash = hash_combine(hash, static_cast<size_t>(m.get(i)));
+			}
+			return hash;
 		}
-		return hash;
 	}
 };
 
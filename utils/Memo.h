@@ -0,0 +1,153 @@
+#ifndef MEMO_H
+#define MEMO_H
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <Logger.h>
+
+#include "FlatMap.h"
+
+/* ====================================================================================================
+ * Memoization
+ */
+
+template<typename Signature>
+class Memo;
+
+/**
+ * Cache for a recursive function. The function gets the memo as first argument for its recursive calls:
+ *   Memo<int64_t(int, int)> paths([&](auto& self, int x, int y) -> int64_t {
+ *       if (x == 0 || y == 0) return 1;
+ *       return self(x - 1, y) + self(x, y - 1);
+ *   });
+ *   paths.set_bounds({0, 100}, {0, 100}); // optional: dense array instead of the hash table
+ *   paths(100, 100);
+ *   paths.log_stats("paths");
+ *
+ * Arguments are stored as std::tuple<std::decay_t<Args>...> in a FlatMap. Calls with integral
+ * arguments inside the declared bounds go to a flat multidimensional array, all others to the table.
+ */
+template<typename Result, typename... Args>
+class Memo<Result(Args...)> {
+public:
+	using Key = std::tuple<std::decay_t<Args>...>;
+	using Function = std::function<Result(Memo&, Args...)>;
+
+	static constexpr bool dense_capable = (std::is_integral_v<std::decay_t<Args>> && ...);
+
+private:
+	Function fn;
+	FlatMap<Key, Result> table{};
+
+	std::array<int64_t, sizeof...(Args)> lower{};
+	std::array<int64_t, sizeof...(Args)> extent{};
+	std::vector<Result> dense_values{};
+	std::vector<uint8_t> dense_known{};
+	size_t dense_count = 0;
+
+	size_t hit_count = 0;
+	size_t miss_count = 0;
+
+public:
+	explicit Memo(Function fn) : fn(std::move(fn)) {}
+
+	Result operator()(Args... args) {
+		if constexpr (dense_capable) {
+			if (!dense_known.empty()) {
+				if (auto index = dense_index(args...)) {
+					if (dense_known[*index]) {
+						++hit_count;
+						return dense_values[*index];
+					}
+					++miss_count;
+					Result result = fn(*this, args...);
+					dense_values[*index] = result;
+					dense_known[*index] = 1;
+					++dense_count;
+					return result;
+				}
+			}
+		}
+
+		Key key(args...);
+		if (auto it = table.find(key); it != table.end()) {
+			++hit_count;
+			return it->second;
+		}
+		++miss_count;
+		// the recursive calls may grow the table, so nothing is kept across them
+		Result result = fn(*this, args...);
+		table.insert_or_assign(key, result);
+		return result;
+	}
+
+	/**
+	 * Declares the inclusive range of every argument and allocates a dense array for it;
+	 * calls outside of it still use the hash table. Clears the cache.
+	 */
+	void set_bounds(std::pair<std::decay_t<Args>, std::decay_t<Args>>... bounds) requires dense_capable {
+		size_t size = 1;
+		size_t i = 0;
+		((lower[i] = static_cast<int64_t>(bounds.first),
+			extent[i] = static_cast<int64_t>(bounds.second) - static_cast<int64_t>(bounds.first) + 1,
+			++i), ...);
+		for (const auto e : extent) {
+			if (e <= 0) {
+				Logger::critical("Memo::set_bounds: empty range");
+			}
+			size *= static_cast<size_t>(e);
+		}
+		clear();
+		dense_values.assign(size, Result{});
+		dense_known.assign(size, 0);
+	}
+
+	/**
+	 * Expected number of entries in the hash table
+	 */
+	void reserve(size_t n) { table.reserve(n); }
+
+	void clear() {
+		table.clear();
+		std::fill(dense_known.begin(), dense_known.end(), 0);
+		dense_count = 0;
+		hit_count = 0;
+		miss_count = 0;
+	}
+
+	size_t hits() const { return hit_count; }
+	size_t misses() const { return miss_count; }
+	size_t size() const { return table.size() + dense_count; }
+
+	/**
+	 * Logs hits, misses and the share of calls served from the cache
+	 */
+	void log_stats(std::string_view name) const {
+		const size_t calls = hit_count + miss_count;
+		Logger::info("Memo {}: {} call(s), {} hit(s), {} miss(es) ({:.1f}% hit rate), {} entries ({} dense / {} hashed)",
+			name, calls, hit_count, miss_count,
+			calls == 0 ? 0.0 : 100.0 * static_cast<double>(hit_count) / static_cast<double>(calls),
+			size(), dense_count, table.size());
+	}
+
+private:
+	std::optional<size_t> dense_index(const std::decay_t<Args>&... args) const {
+		size_t index = 0;
+		size_t i = 0;
+		bool inside = true;
+		((inside = inside && static_cast<int64_t>(args) >= lower[i] && static_cast<int64_t>(args) - lower[i] < extent[i],
+			index = index * static_cast<size_t>(extent[i]) + static_cast<size_t>(static_cast<int64_t>(args) - lower[i]),
+			++i), ...);
+		return inside ? std::optional<size_t>(index) : std::nullopt;
+	}
+};
+
+#endif //MEMO_H
@@ -0,0 +1,171 @@
+#include "MemoryStats.h"
+
+#include "utils.h"
+
+#include <cstdlib>
+#include <new>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+namespace {
+
+// counters of the HeapTracker that is active on this thread; constant-initialized, so safe in operator new
+thread_local HeapTracker::Counters* active_counters = nullptr;
+
+#if !defined(_MSC_VER)
+
+size_t usable_size([[maybe_unused]] void* p) {
+#if defined(__GLIBC__)
+	return malloc_usable_size(p);
+#else
+	return 0;
+#endif
+}
+
+void count_allocation(void* p, size_t size) {
+	auto* counters = active_counters;
+	if (counters == nullptr) return;
+	++counters->allocations;
+	counters->bytes += size;
+	counters->live += static_cast<int64_t>(usable_size(p));
+	counters->peak = std::max(counters->peak, counters->live);
+}
+
+void count_deallocation(void* p) {
+	auto* counters = active_counters;
+	if (counters == nullptr || p == nullptr) return;
+	++counters->deallocations;
+	counters->live -= static_cast<int64_t>(usable_size(p));
+}
+
+/**
+ * malloc / aligned_alloc with the new_handler loop of the standard operator new
+ * @return nullptr if there is no new_handler left to try
+ */
+void* allocate(size_t size, size_t alignment) {
+	if (size == 0) size = 1;
+	for (;;) {
+		void* p = alignment <= __STDCPP_DEFAULT_NEW_ALIGNMENT__
+			? std::malloc(size)
+			: std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+		if (p != nullptr) {
+			count_allocation(p, size);
+			return p;
+		}
+		const auto handler = std::get_new_handler();
+		if (handler == nullptr) return nullptr;
+		handler();
+	}
+}
+
+void* allocate_or_throw(size_t size, size_t alignment) {
+	void* p = allocate(size, alignment);
+	if (p == nullptr) throw std::bad_alloc();
+	return p;
+}
+
+void* allocate_nothrow(size_t size, size_t alignment) noexcept {
+	try {
+		return allocate(size, alignment);
+	} catch (...) {
+		return nullptr;
+	}
+}
+
+void deallocate(void* p) noexcept {
+	count_deallocation(p);
+	std::free(p);
+}
+
+#endif
+
+}
+
+#if !defined(_MSC_VER)
+
+void* operator new(size_t size) { return allocate_or_throw(size, 0); }
+void* operator new[](size_t size) { return allocate_or_throw(size, 0); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return allocate_nothrow(size, 0); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return allocate_nothrow(size, 0); }
+void* operator new(size_t size, std::align_val_t alignment) { return allocate_or_throw(size, static_cast<size_t>(alignment)); }
+void* operator new[](size_t size, std::align_val_t alignment) { return allocate_or_throw(size, static_cast<size_t>(alignment)); }
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return allocate_nothrow(size, static_cast<size_t>(alignment)); }
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return allocate_nothrow(size, static_cast<size_t>(alignment)); }
+
+void operator delete(void* p) noexcept { deallocate(p); }
+void operator delete[](void* p) noexcept { deallocate(p); }
+void operator delete(void* p, size_t) noexcept { deallocate(p); }
+void operator delete[](void* p, size_t) noexcept { deallocate(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { deallocate(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { deallocate(p); }
+void operator delete(void* p, std::align_val_t) noexcept { deallocate(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { deallocate(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { deallocate(p); }
+void operator delete[](void* p, size_t, std::align_val_t) noexcept { deallocate(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { deallocate(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { deallocate(p); }
+
+#endif
+
+bool heap_tracking_supported() {
+#if defined(_MSC_VER)
+	return false;
+#else
+	return true;
+#endif
+}
+
+HeapTracker::HeapTracker() : previous(active_counters) {
+	active_counters = &counters;
+}
+
+HeapTracker::~HeapTracker() {
+	active_counters = previous;
+}
+
+HeapStats HeapTracker::stats() const {
+	return HeapStats{counters.allocations, counters.deallocations, counters.bytes, static_cast<size_t>(counters.peak)};
+}
+
+size_t peak_rss() {
+#if defined(__linux__)
+	std::ifstream status("/proc/self/status");
+	std::string line;
+	while (std::getline(status, line)) {
+		if (line.starts_with("VmHWM:")) {
+			return parse_number<size_t>(std::string_view(line).substr(6)) * 1024;
+		}
+	}
+#endif
+	return 0;
+}
+
+bool reset_peak_rss() {
+#if defined(__linux__)
+	std::ofstream clear_refs("/proc/self/clear_refs");
+	clear_refs << "5";
+	clear_refs.close();
+	return !clear_refs.fail();
+#else
+	return false;
+#endif
+}
+
+std::string format_memory_stats(const MemoryStats& stats) {
+	std::string result = "";
+	const auto append = [&](const std::string& part) {
+		result += result.empty() ? part : ", " + part;
+	};
+	if (heap_tracking_supported()) {
+		append(fmt::format("{} allocation(s) / {}", stats.heap.allocations, format_bytes(stats.heap.bytes)));
+	}
+	if (stats.heap.peak > 0) {
+		append(fmt::format("heap peak {}", format_bytes(stats.heap.peak)));
+	}
+	if (stats.peak_rss > 0) {
+		append(fmt::format("peak RSS {}{}", format_bytes(stats.peak_rss), stats.rss_reset ? "" : " (process)"));
+	}
+	return result;
+}
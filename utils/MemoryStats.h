@@ -0,0 +1,82 @@
+#ifndef MEMORYSTATS_H
+#define MEMORYSTATS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/* ====================================================================================================
+ * Heap and RSS Accounting
+ */
+
+struct HeapStats {
+	/** calls of the global operator new (all forms) */
+	size_t allocations = 0;
+	/** calls of the global operator delete with a non-null pointer */
+	size_t deallocations = 0;
+	/** sum of all requested bytes */
+	size_t bytes = 0;
+	/** highest heap usage above the level at the start (usable sizes; glibc only, 0 elsewhere) */
+	size_t peak = 0;
+};
+
+/**
+ * true if this build replaces the global operator new / delete (everything but MSVC)
+ */
+bool heap_tracking_supported();
+
+/**
+ * Counts the global operator new / delete calls made on the current thread while it is alive.
+ * aoc_utils always replaces the global operator new; without an active tracker that costs
+ * one thread-local load per call. Memory from run_memory() only shows up as the arena's blocks.
+ */
+class HeapTracker {
+public:
+	struct Counters {
+		size_t allocations = 0;
+		size_t deallocations = 0;
+		size_t bytes = 0;
+		int64_t live = 0;
+		int64_t peak = 0;
+	};
+
+private:
+	Counters counters{};
+	Counters* previous;
+
+public:
+	HeapTracker();
+	~HeapTracker();
+
+	HeapTracker(const HeapTracker&) = delete;
+	HeapTracker& operator=(const HeapTracker&) = delete;
+
+	HeapStats stats() const;
+};
+
+/**
+ * Peak resident set size of the process (VmHWM in /proc/self/status)
+ * @return bytes; 0 if unavailable (not Linux)
+ */
+size_t peak_rss();
+
+/**
+ * Resets the peak resident set size to the current one (writes "5" to /proc/self/clear_refs)
+ * @return false if that is not possible - peak_rss() then covers the whole process lifetime
+ */
+bool reset_peak_rss();
+
+struct MemoryStats {
+	HeapStats heap{};
+	/** peak resident set size of the whole process during the run */
+	size_t peak_rss = 0;
+	/** false if the peak could not be reset before the run, so it may stem from earlier */
+	bool rss_reset = false;
+};
+
+/**
+ * Formats the stats as "N allocation(s) / X, heap peak Y, peak RSS Z" (leaving out what is unavailable)
+ */
+std::string format_memory_stats(const MemoryStats& stats);
+
+#endif //MEMORYSTATS_H
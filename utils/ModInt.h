@@ -0,0 +1,127 @@
+#ifndef MODINT_H
+#define MODINT_H
+
+#include <concepts>
+#include <cstdint>
+#include <ostream>
+#include <type_traits>
+#include <utility>
+
+#include <Logger.h>
+
+/* ====================================================================================================
+ * Modular arithmetic
+ */
+
+/**
+ * Integer modulo P, usable as T in Matrix / DynMatrix (e.g. Matrix<3, 3, ModInt<1'000'000'007>>::pow)
+ * Division needs the divisor to be coprime to P (always true for prime P and a non-zero divisor).
+ */
+template<uint64_t P>
+class ModInt {
+	static_assert(P >= 1 && P <= static_cast<uint64_t>(INT64_MAX), "ModInt needs 1 <= P < 2^63");
+
+private:
+	uint64_t v = 0;
+
+	static constexpr uint64_t mul_mod(uint64_t a, uint64_t b) {
+		if constexpr (P <= (uint64_t{1} << 32)) {
+			return a * b % P;
+		} else {
+#if defined(__SIZEOF_INT128__)
+			return static_cast<uint64_t>(static_cast<__uint128_t>(a) * b % P);
+#else
+			uint64_t result = 0;
+			for (a %= P; b > 0; b >>= 1) {
+				if (b & 1) result = result >= P - a ? result - (P - a) : result + a;
+				a = a >= P - a ? a - (P - a) : a + a;
+			}
+			return result;
+#endif
+		}
+	}
+
+public:
+	constexpr ModInt() = default;
+
+	template<std::integral I>
+	constexpr ModInt(I value) {
+		if constexpr (std::is_signed_v<I>) {
+			const int64_t r = static_cast<int64_t>(value) % static_cast<int64_t>(P);
+			v = static_cast<uint64_t>(r < 0 ? r + static_cast<int64_t>(P) : r);
+		} else {
+			v = static_cast<uint64_t>(value) % P;
+		}
+	}
+
+	static constexpr uint64_t modulus() { return P; }
+
+	/** representative in [0, P) */
+	constexpr uint64_t value() const { return v; }
+
+	constexpr ModInt& operator+=(ModInt other) {
+		v = v >= P - other.v ? v - (P - other.v) : v + other.v;
+		return *this;
+	}
+
+	constexpr ModInt& operator-=(ModInt other) {
+		v = v >= other.v ? v - other.v : v + (P - other.v);
+		return *this;
+	}
+
+	constexpr ModInt& operator*=(ModInt other) {
+		v = mul_mod(v, other.v);
+		return *this;
+	}
+
+	constexpr ModInt& operator/=(ModInt other) {
+		return *this *= other.inverse();
+	}
+
+	friend constexpr ModInt operator+(ModInt a, ModInt b) { return a += b; }
+	friend constexpr ModInt operator-(ModInt a, ModInt b) { return a -= b; }
+	friend constexpr ModInt operator*(ModInt a, ModInt b) { return a *= b; }
+	friend constexpr ModInt operator/(ModInt a, ModInt b) { return a /= b; }
+
+	constexpr ModInt operator-() const { return ModInt() - *this; }
+
+	constexpr bool operator==(const ModInt& other) const = default;
+
+	/**
+	 * this^k by binary exponentiation
+	 */
+	constexpr ModInt pow(uint64_t k) const {
+		ModInt result(1);
+		ModInt base = *this;
+		for (; k > 0; k >>= 1) {
+			if (k & 1) result *= base;
+			base *= base;
+		}
+		return result;
+	}
+
+	/**
+	 * Multiplicative inverse by the extended Euclidean algorithm
+	 */
+	ModInt inverse() const {
+		int64_t a = static_cast<int64_t>(v), b = static_cast<int64_t>(P);
+		int64_t x = 1, y = 0;
+		while (b != 0) {
+			const int64_t q = a / b;
+			a -= q * b;
+			x -= q * y;
+			std::swap(a, b);
+			std::swap(x, y);
+		}
+		if (a != 1) {
+			Logger::critical("ModInt: {} has no inverse modulo {}", v, P);
+		}
+		return ModInt(x);
+	}
+
+	friend std::ostream& operator<<(std::ostream& os, const ModInt& m) {
+		return os << m.v;
+	}
+};
+
+#endif //MODINT_H
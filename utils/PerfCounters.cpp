@@ -0,0 +1,224 @@
+#include "PerfCounters.h"
+
+#include "utils.h"
+
+#if defined(__linux__)
+#include <cerrno>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+std::optional<double> PerfStats::ipc() const {
+	auto cycles = (*this)[PerfEvent::CYCLES];
+	auto instructions = (*this)[PerfEvent::INSTRUCTIONS];
+	if (!cycles.has_value() || !instructions.has_value() || *cycles == 0) return std::nullopt;
+	return static_cast<double>(*instructions) / static_cast<double>(*cycles);
+}
+
+#if defined(__linux__)
+
+namespace {
+
+constexpr uint64_t cache_event(uint64_t cache, uint64_t op, uint64_t result) {
+	return cache | (op << 8) | (result << 16);
+}
+
+perf_event_attr event_attr(PerfEvent event) {
+	perf_event_attr attr{};
+	attr.size = sizeof(attr);
+	attr.disabled = 1;
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+	attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+	switch (event) {
+		case PerfEvent::CYCLES:
+			attr.type = PERF_TYPE_HARDWARE;
+			attr.config = PERF_COUNT_HW_CPU_CYCLES;
+			break;
+		case PerfEvent::INSTRUCTIONS:
+			attr.type = PERF_TYPE_HARDWARE;
+			attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+			break;
+		case PerfEvent::L1D_MISSES:
+			attr.type = PERF_TYPE_HW_CACHE;
+			attr.config = cache_event(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS);
+			break;
+		case PerfEvent::LLC_MISSES:
+			attr.type = PERF_TYPE_HARDWARE;
+			attr.config = PERF_COUNT_HW_CACHE_MISSES;
+			break;
+		case PerfEvent::BRANCHES:
+			attr.type = PERF_TYPE_HARDWARE;
+			attr.config = PERF_COUNT_HW_BRANCH_INSTRUCTIONS;
+			break;
+		case PerfEvent::BRANCH_MISSES:
+			attr.type = PERF_TYPE_HARDWARE;
+			attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+			break;
+	}
+	return attr;
+}
+
+std::string open_error(int error) {
+	switch (error) {
+		case EACCES:
+		case EPERM:
+			return fmt::format("{} - check /proc/sys/kernel/perf_event_paranoid", std::strerror(error));
+		case ENOENT:
+		case EOPNOTSUPP:
+			return fmt::format("{} - no hardware PMU (VM or container?)", std::strerror(error));
+		case ENOSYS:
+			return "perf_event_open is not supported by this kernel";
+		default:
+			return std::strerror(error);
+	}
+}
+
+}
+
+PerfCounters::PerfCounters() {
+	for (size_t i = 0; i < PERF_EVENT_COUNT; ++i) {
+		auto attr = event_attr(static_cast<PerfEvent>(i));
+		// this thread only, on any CPU
+		counters[i].fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+		if (counters[i].fd < 0 && error.empty()) {
+			error = open_error(errno);
+		}
+	}
+	if (available()) {
+		error = "";
+	}
+}
+
+PerfCounters::~PerfCounters() {
+	for (auto& counter : counters) {
+		if (counter.fd >= 0) {
+			close(counter.fd);
+		}
+	}
+}
+
+void PerfCounters::start() {
+	for (auto& counter : counters) {
+		if (counter.fd < 0) continue;
+		ioctl(counter.fd, PERF_EVENT_IOC_RESET, 0);
+		ioctl(counter.fd, PERF_EVENT_IOC_ENABLE, 0);
+	}
+}
+
+void PerfCounters::stop() {
+	for (auto& counter : counters) {
+		if (counter.fd >= 0) {
+			ioctl(counter.fd, PERF_EVENT_IOC_DISABLE, 0);
+		}
+	}
+	++runs;
+
+	for (auto& counter : counters) {
+		if (counter.fd < 0) continue;
+		// value, time enabled, time running
+		uint64_t values[3] = {};
+		if (read(counter.fd, values, sizeof(values)) != sizeof(values) || values[2] == 0) continue;
+		if (values[2] < values[1]) {
+			// multiplexed with other events: extrapolate to the whole run
+			scaled = true;
+			values[0] = static_cast<uint64_t>(static_cast<double>(values[0]) * values[1] / values[2]);
+		}
+		counter.total += values[0];
+		++counter.runs;
+	}
+}
+
+#else
+
+PerfCounters::PerfCounters() : error("hardware counters are only supported on Linux") {}
+
+PerfCounters::~PerfCounters() = default;
+
+void PerfCounters::start() {}
+
+void PerfCounters::stop() {
+	++runs;
+}
+
+#endif
+
+bool PerfCounters::available() const {
+	return std::ranges::any_of(counters, [](const Counter& counter) { return counter.fd >= 0; });
+}
+
+PerfStats PerfCounters::stats() const {
+	PerfStats result{};
+	result.runs = runs;
+	result.scaled = scaled;
+	result.error = error;
+	for (size_t i = 0; i < PERF_EVENT_COUNT; ++i) {
+		if (counters[i].runs > 0) {
+			result.counts[i] = counters[i].total / counters[i].runs;
+		}
+	}
+	return result;
+}
+
+static std::string format_count(uint64_t count) {
+	const char* units[] = {"k", "M", "G", "T"};
+	if (count < 1000) {
+		return fmt::format("{}", count);
+	}
+	double value = static_cast<double>(count) / 1000.0;
+	int unit = 0;
+	while (value >= 1000.0 && unit < 3) {
+		value /= 1000.0;
+		unit++;
+	}
+	return fmt::format("{:.2f} {}", value, units[unit]);
+}
+
+std::string format_perf_stats(const PerfStats& stats) {
+	if (!stats.error.empty()) {
+		return fmt::format("unavailable ({})", stats.error);
+	}
+
+	std::string result = "";
+	const auto append = [&](const std::string& part) {
+		result += result.empty() ? part : ", " + part;
+	};
+	const auto append_count = [&](PerfEvent event, const char* name) {
+		if (auto count = stats[event]) {
+			append(fmt::format("{} {}", format_count(*count), name));
+		}
+	};
+
+	append_count(PerfEvent::CYCLES, "cycles");
+	append_count(PerfEvent::INSTRUCTIONS, "instructions");
+	if (auto ipc = stats.ipc()) {
+		append(fmt::format("IPC {:.2f}", *ipc));
+	}
+	append_count(PerfEvent::L1D_MISSES, "L1d misses");
+	append_count(PerfEvent::LLC_MISSES, "LLC misses");
+	if (auto misses = stats[PerfEvent::BRANCH_MISSES]) {
+		auto branches = stats[PerfEvent::BRANCHES];
+		if (branches.has_value() && *branches > 0) {
+			append(fmt::format("{} branch misses ({:.2f}% of {} branches)", format_count(*misses),
+				100.0 * static_cast<double>(*misses) / static_cast<double>(*branches), format_count(*branches)));
+		} else {
+			append(fmt::format("{} branch misses", format_count(*misses)));
+		}
+	} else {
+		append_count(PerfEvent::BRANCHES, "branches");
+	}
+
+	if (result.empty()) {
+		return "no counter was scheduled";
+	}
+	if (stats.runs > 1) {
+		result += " per run";
+	}
+	if (stats.scaled) {
+		result += " (multiplexed)";
+	}
+	return result;
+}
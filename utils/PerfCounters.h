@@ -0,0 +1,91 @@
+#ifndef PERFCOUNTERS_H
+#define PERFCOUNTERS_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+/* ====================================================================================================
+ * Hardware Performance Counters
+ */
+
+enum class PerfEvent {
+	CYCLES,
+	INSTRUCTIONS,
+	L1D_MISSES,
+	LLC_MISSES,
+	BRANCHES,
+	BRANCH_MISSES,
+};
+
+constexpr size_t PERF_EVENT_COUNT = 6;
+
+struct PerfStats {
+	/** number of measured runs the counts are averaged over */
+	size_t runs = 0;
+	/** counts per run; empty for events that could not be opened or were never scheduled */
+	std::array<std::optional<uint64_t>, PERF_EVENT_COUNT> counts{};
+	/** true if the kernel had to multiplex the counters, so the counts are scaled estimates */
+	bool scaled = false;
+	/** why no counter could be opened; empty if at least one is available */
+	std::string error = "";
+
+	std::optional<uint64_t> operator[](PerfEvent event) const { return counts[static_cast<size_t>(event)]; }
+
+	/** instructions per cycle; empty if either is missing */
+	std::optional<double> ipc() const;
+};
+
+/**
+ * Per-thread hardware counters (cycles, instructions, L1d read misses, LLC misses, branches and
+ * branch mispredictions) of the calling thread, opened with perf_event_open. User space only, so
+ * perf_event_paranoid <= 2 is enough. Every event is opened on its own: missing events (VMs,
+ * containers, other CPUs) are left out instead of failing the whole set. Outside of Linux nothing
+ * is available.
+ * start() / stop() enclose one measured run; the counts of all runs are summed up.
+ */
+class PerfCounters {
+private:
+	struct Counter {
+		int fd = -1;
+		uint64_t total = 0;
+		/** runs in which the counter was actually scheduled */
+		size_t runs = 0;
+	};
+
+	std::array<Counter, PERF_EVENT_COUNT> counters{};
+	size_t runs = 0;
+	bool scaled = false;
+	std::string error = "";
+
+public:
+	/**
+	 * Opens the counters disabled; errors are kept for stats()
+	 */
+	PerfCounters();
+	~PerfCounters();
+
+	PerfCounters(const PerfCounters&) = delete;
+	PerfCounters& operator=(const PerfCounters&) = delete;
+
+	/** true if at least one counter could be opened */
+	bool available() const;
+
+	/** resets and enables the counters */
+	void start();
+	/** disables the counters and adds their (scaled) values to the totals */
+	void stop();
+
+	/** averages over the runs since construction */
+	PerfStats stats() const;
+};
+
+/**
+ * Formats the stats as "1.52 G cycles, 3.01 G instructions, IPC 1.98, 12.4 M L1d misses, ..."
+ * leaving out missing events; "unavailable (reason)" if there are none
+ */
+std::string format_perf_stats(const PerfStats& stats);
+
+#endif //PERFCOUNTERS_H
@@ -0,0 +1,153 @@
+#ifndef RATIONAL_H
+#define RATIONAL_H
+
+#include <compare>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+#include <Logger.h>
+
+/* ====================================================================================================
+ * Exact fractions
+ */
+
+/**
+ * Fraction num / den in lowest terms with den > 0, for exact elimination in DynMatrix (Rational<int64_t>,
+ * or Rational<__int128> when intermediate values get large). Overflow is reported instead of wrapping.
+ */
+template<typename I>
+class Rational {
+private:
+	I num = 0;
+	I den = 1;
+
+	static constexpr I abs(I value) { return value < 0 ? -value : value; }
+
+	static constexpr I gcd(I a, I b) {
+		a = abs(a);
+		b = abs(b);
+		while (b != 0) {
+			const I t = a % b;
+			a = b;
+			b = t;
+		}
+		return a;
+	}
+
+	static I mul(I a, I b) {
+		I result;
+		if (__builtin_mul_overflow(a, b, &result)) {
+			Logger::critical("Rational: overflow");
+		}
+		return result;
+	}
+
+	static I add(I a, I b) {
+		I result;
+		if (__builtin_add_overflow(a, b, &result)) {
+			Logger::critical("Rational: overflow");
+		}
+		return result;
+	}
+
+	void normalize() {
+		if (den == 0) {
+			Logger::critical("Rational: division by zero");
+		}
+		if (den < 0) {
+			num = -num;
+			den = -den;
+		}
+		const I g = gcd(num, den);
+		if (g > 1) {
+			num /= g;
+			den /= g;
+		}
+	}
+
+public:
+	constexpr Rational() = default;
+
+	Rational(I numerator, I denominator = 1) : num(numerator), den(denominator) {
+		normalize();
+	}
+
+	I numerator() const { return num; }
+	I denominator() const { return den; }
+
+	bool is_integer() const { return den == 1; }
+
+	explicit operator double() const { return static_cast<double>(num) / static_cast<double>(den); }
+
+	Rational& operator+=(const Rational& other) {
+		// a/b + c/d = (a * (d/g) + c * (b/g)) / (b/g * d) keeps the intermediate values small
+		const I g = gcd(den, other.den);
+		num = add(mul(num, other.den / g), mul(other.num, den / g));
+		den = mul(den / g, other.den);
+		normalize();
+		return *this;
+	}
+
+	Rational& operator-=(const Rational& other) {
+		return *this += -other;
+	}
+
+	Rational& operator*=(const Rational& other) {
+		// cross-cancel first, then both products are already in lowest terms
+		const I g1 = gcd(num, other.den);
+		const I g2 = gcd(other.num, den);
+		num = mul(num / g1, other.num / g2);
+		den = mul(den / g2, other.den / g1);
+		normalize();
+		return *this;
+	}
+
+	Rational& operator/=(const Rational& other) {
+		if (other.num == 0) {
+			Logger::critical("Rational: division by zero");
+		}
+		return *this *= Rational(other.den, other.num);
+	}
+
+	friend Rational operator+(Rational a, const Rational& b) { return a += b; }
+	friend Rational operator-(Rational a, const Rational& b) { return a -= b; }
+	friend Rational operator*(Rational a, const Rational& b) { return a *= b; }
+	friend Rational operator/(Rational a, const Rational& b) { return a /= b; }
+
+	Rational operator-() const {
+		Rational result;
+		result.num = -num;
+		result.den = den;
+		return result;
+	}
+
+	bool operator==(const Rational& other) const = default;
+
+	std::strong_ordering operator<=>(const Rational& other) const {
+		return mul(num, other.den) <=> mul(other.num, den);
+	}
+
+	friend std::ostream& operator<<(std::ostream& os, const Rational& r) {
+		os << to_string(r.num);
+		if (r.den != 1) {
+			os << '/' << to_string(r.den);
+		}
+		return os;
+	}
+
+private:
+	// also covers __int128, which has no stream operator
+	static std::string to_string(I value) {
+		if (value == 0) return "0";
+		std::string digits;
+		const bool negative = value < 0;
+		for (; value != 0; value /= 10) {
+			const int digit = static_cast<int>(value % 10);
+			digits.insert(digits.begin(), static_cast<char>('0' + (digit < 0 ? -digit : digit)));
+		}
+		return negative ? "-" + digits : digits;
+	}
+};
+
+#endif //RATIONAL_H
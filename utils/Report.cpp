@@ -0,0 +1,378 @@
+#include "Report.h"
+
+#include "utils.h"
+
+#include <variant>
+
+namespace {
+
+using ReportValue = std::variant<std::monostate, bool, uint64_t, double, std::string>;
+
+struct ReportField {
+	const char* name;
+	ReportValue value;
+};
+
+template<typename T>
+ReportValue optional_value(const std::optional<T>& value) {
+	return value.has_value() ? ReportValue(*value) : ReportValue();
+}
+
+uint64_t ns(std::chrono::nanoseconds duration) {
+	return static_cast<uint64_t>(duration.count());
+}
+
+/**
+ * All columns of a record in output order
+ */
+std::vector<ReportField> report_fields(const ReportRecord& record) {
+	std::vector<ReportField> fields = {
+		{"year", uint64_t(record.year)},
+		{"day", uint64_t(record.day)},
+		{"part", uint64_t(record.part)},
+		{"kind", record.kind},
+		{"input", record.input},
+		{"result", record.result},
+		{"expected", optional_value(record.expected)},
+		{"passed", optional_value(record.passed)},
+		{"runs", uint64_t(record.runs)},
+		{"warmup", uint64_t(record.warmup)},
+		{"min_ns", ns(record.min)},
+		{"median_ns", ns(record.median)},
+		{"p90_ns", ns(record.p90)},
+		{"max_ns", ns(record.max)},
+		{"mean_ns", ns(record.mean)},
+		{"stddev_ns", ns(record.stddev)},
+		{"unstable", record.unstable},
+	};
+
+	const auto& arena = record.arena;
+	fields.push_back({"arena_allocations", arena ? ReportValue(uint64_t(arena->allocations)) : ReportValue()});
+	fields.push_back({"arena_bytes", arena ? ReportValue(uint64_t(arena->bytes)) : ReportValue()});
+	fields.push_back({"arena_peak", arena ? ReportValue(uint64_t(arena->peak)) : ReportValue()});
+	fields.push_back({"arena_reserved", arena ? ReportValue(uint64_t(arena->reserved)) : ReportValue()});
+
+	const auto& memory = record.memory;
+	fields.push_back({"heap_allocations", memory ? ReportValue(uint64_t(memory->heap.allocations)) : ReportValue()});
+	fields.push_back({"heap_deallocations", memory ? ReportValue(uint64_t(memory->heap.deallocations)) : ReportValue()});
+	fields.push_back({"heap_bytes", memory ? ReportValue(uint64_t(memory->heap.bytes)) : ReportValue()});
+	fields.push_back({"heap_peak", memory && memory->heap.peak > 0 ? ReportValue(uint64_t(memory->heap.peak)) : ReportValue()});
+	fields.push_back({"peak_rss", memory && memory->peak_rss > 0 ? ReportValue(uint64_t(memory->peak_rss)) : ReportValue()});
+
+	const auto perf_count = [&](PerfEvent event) {
+		return record.perf ? optional_value((*record.perf)[event]) : ReportValue();
+	};
+	fields.push_back({"cycles", perf_count(PerfEvent::CYCLES)});
+	fields.push_back({"instructions", perf_count(PerfEvent::INSTRUCTIONS)});
+	fields.push_back({"ipc", record.perf ? optional_value(record.perf->ipc()) : ReportValue()});
+	fields.push_back({"l1d_misses", perf_count(PerfEvent::L1D_MISSES)});
+	fields.push_back({"llc_misses", perf_count(PerfEvent::LLC_MISSES)});
+	fields.push_back({"branches", perf_count(PerfEvent::BRANCHES)});
+	fields.push_back({"branch_misses", perf_count(PerfEvent::BRANCH_MISSES)});
+	fields.push_back({"perf_scaled", record.perf && record.perf->error.empty() ? ReportValue(record.perf->scaled) : ReportValue()});
+	return fields;
+}
+
+std::string json_string(std::string_view s) {
+	std::string result = "\"";
+	for (char c : s) {
+		switch (c) {
+			case '"': result += "\\\""; break;
+			case '\\': result += "\\\\"; break;
+			case '\n': result += "\\n"; break;
+			case '\r': result += "\\r"; break;
+			case '\t': result += "\\t"; break;
+			default:
+				if (static_cast<unsigned char>(c) < 0x20) {
+					result += fmt::format("\\u{:04x}", static_cast<unsigned>(c));
+				} else {
+					result += c;
+				}
+		}
+	}
+	return result + "\"";
+}
+
+std::string csv_string(std::string_view s) {
+	if (s.find_first_of(",\"\r\n") == std::string_view::npos) {
+		return std::string(s);
+	}
+	std::string result = "\"";
+	for (char c : s) {
+		if (c == '"') result += '"';
+		result += c;
+	}
+	return result + "\"";
+}
+
+std::string format_value(const ReportValue& value, ReportFormat format) {
+	return std::visit([&]<typename T>(const T& v) -> std::string {
+		if constexpr (std::is_same_v<T, std::monostate>) {
+			return format == ReportFormat::JSON ? "null" : "";
+		} else if constexpr (std::is_same_v<T, bool>) {
+			return v ? "true" : "false";
+		} else if constexpr (std::is_same_v<T, std::string>) {
+			return format == ReportFormat::JSON ? json_string(v) : csv_string(v);
+		} else if constexpr (std::is_same_v<T, double>) {
+			return fmt::format("{:.4f}", v);
+		} else {
+			return fmt::format("{}", v);
+		}
+	}, value);
+}
+
+std::string report_line(const std::vector<ReportField>& fields, ReportFormat format) {
+	std::string line = format == ReportFormat::JSON ? "{" : "";
+	for (size_t i = 0; i < fields.size(); ++i) {
+		if (i > 0) line += format == ReportFormat::JSON ? ", " : ",";
+		if (format == ReportFormat::JSON) {
+			line += json_string(fields[i].name) + ": ";
+		}
+		line += format_value(fields[i].value, format);
+	}
+	return line + (format == ReportFormat::JSON ? "}" : "");
+}
+
+/* ----------------------------------------------------------------------------------------------------
+ * Reading - only flat records as written above
+ */
+
+using RawRecord = std::unordered_map<std::string, std::string>;
+
+void skip_whitespace(std::string_view s, size_t& pos) {
+	while (pos < s.size() && std::isspace(static_cast<unsigned char>(s[pos]))) ++pos;
+}
+
+std::optional<std::string> parse_json_string(std::string_view s, size_t& pos) {
+	if (pos >= s.size() || s[pos] != '"') return std::nullopt;
+	std::string result = "";
+	for (++pos; pos < s.size(); ++pos) {
+		char c = s[pos];
+		if (c == '"') {
+			++pos;
+			return result;
+		}
+		if (c != '\\') {
+			result += c;
+			continue;
+		}
+		if (++pos >= s.size()) return std::nullopt;
+		switch (s[pos]) {
+			case 'n': result += '\n'; break;
+			case 'r': result += '\r'; break;
+			case 't': result += '\t'; break;
+			case 'b': result += '\b'; break;
+			case 'f': result += '\f'; break;
+			case 'u': {
+				// only the control characters json_string writes
+				unsigned code = 0;
+				if (pos + 4 >= s.size()) return std::nullopt;
+				auto [ptr, ec] = std::from_chars(s.data() + pos + 1, s.data() + pos + 5, code, 16);
+				if (ec != std::errc() || code > 0x7f) return std::nullopt;
+				result += static_cast<char>(code);
+				pos += 4;
+				break;
+			}
+			default: result += s[pos];
+		}
+	}
+	return std::nullopt;
+}
+
+std::optional<RawRecord> parse_json_record(std::string_view line) {
+	RawRecord record{};
+	size_t pos = 0;
+	skip_whitespace(line, pos);
+	if (pos >= line.size() || line[pos++] != '{') return std::nullopt;
+
+	for (;;) {
+		skip_whitespace(line, pos);
+		if (pos < line.size() && line[pos] == '}') return record;
+
+		auto key = parse_json_string(line, pos);
+		skip_whitespace(line, pos);
+		if (!key.has_value() || pos >= line.size() || line[pos++] != ':') return std::nullopt;
+		skip_whitespace(line, pos);
+
+		if (pos < line.size() && line[pos] == '"') {
+			auto value = parse_json_string(line, pos);
+			if (!value.has_value()) return std::nullopt;
+			record[*key] = *value;
+		} else {
+			size_t end = line.find_first_of(",}", pos);
+			if (end == std::string_view::npos) return std::nullopt;
+			auto value = trim(std::string(line.substr(pos, end - pos)));
+			if (value != "null") {
+				record[*key] = value;
+			}
+			pos = end;
+		}
+
+		skip_whitespace(line, pos);
+		if (pos >= line.size()) return std::nullopt;
+		if (line[pos] == '}') return record;
+		if (line[pos++] != ',') return std::nullopt;
+	}
+}
+
+/**
+ * Splits CSV content into rows of fields; quoted fields may contain separators, quotes ("") and line breaks
+ */
+std::optional<std::vector<std::vector<std::string>>> parse_csv(std::string_view s) {
+	std::vector<std::vector<std::string>> rows{};
+	std::vector<std::string> row{};
+	std::string field = "";
+	bool quoted = false;
+
+	for (size_t i = 0; i < s.size(); ++i) {
+		char c = s[i];
+		if (quoted) {
+			if (c != '"') {
+				field += c;
+			} else if (i + 1 < s.size() && s[i + 1] == '"') {
+				field += '"';
+				++i;
+			} else {
+				quoted = false;
+			}
+		} else if (c == '"') {
+			quoted = true;
+		} else if (c == ',') {
+			row.push_back(std::exchange(field, ""));
+		} else if (c == '\n') {
+			row.push_back(std::exchange(field, ""));
+			rows.push_back(std::exchange(row, {}));
+		} else if (c != '\r') {
+			field += c;
+		}
+	}
+	if (quoted) return std::nullopt;
+	if (!field.empty() || !row.empty()) {
+		row.push_back(field);
+		rows.push_back(row);
+	}
+	return rows;
+}
+
+std::vector<RawRecord> read_raw_records(const std::string& path, std::string_view content) {
+	std::vector<RawRecord> records{};
+	size_t start = 0;
+	skip_whitespace(content, start);
+	if (start >= content.size()) return records;
+
+	if (content[start] == '{') {
+		size_t line_number = 0;
+		for (auto line : split_lines_view(content)) {
+			++line_number;
+			if (trim(std::string(line)).empty()) continue;
+			auto record = parse_json_record(line);
+			if (!record.has_value()) {
+				Logger::critical("Malformed record in '{}' on line {}", path, line_number);
+			}
+			records.push_back(std::move(*record));
+		}
+		return records;
+	}
+
+	auto rows = parse_csv(content);
+	if (!rows.has_value()) {
+		Logger::critical("Unterminated quote in '{}'", path);
+	}
+	const auto& header = rows->front();
+	for (size_t i = 1; i < rows->size(); ++i) {
+		const auto& row = (*rows)[i];
+		if (row.size() == 1 && row[0].empty()) continue;
+		if (row.size() != header.size()) {
+			Logger::critical("Row {} in '{}' has {} fields instead of {}", i + 1, path, row.size(), header.size());
+		}
+		RawRecord record{};
+		for (size_t j = 0; j < header.size(); ++j) {
+			if (!row[j].empty()) {
+				record[header[j]] = row[j];
+			}
+		}
+		records.push_back(std::move(record));
+	}
+	return records;
+}
+
+const std::string& required_field(const RawRecord& record, const std::string& path, const char* name) {
+	auto it = record.find(name);
+	if (it == record.end()) {
+		Logger::critical("Record in '{}' is missing the field '{}'", path, name);
+	}
+	return it->second;
+}
+
+std::string report_key(int year, int day, int part, std::string_view kind, std::string_view input) {
+	return fmt::format("{}/{}/{}/{}/{}", year, day, part, kind, input);
+}
+
+}
+
+std::string ReportRecord::key() const {
+	return report_key(year, day, part, kind, input);
+}
+
+void write_report(const std::string& path, ReportFormat format, const std::vector<ReportRecord>& records) {
+	std::error_code ec;
+	const bool empty = !std::filesystem::exists(path, ec) || std::filesystem::file_size(path, ec) == 0;
+
+	std::ofstream file(path, std::ios::app | std::ios::binary);
+	if (!file.is_open()) {
+		Logger::critical("Could not open file '{}'", path);
+	}
+
+	if (format == ReportFormat::CSV && empty && !records.empty()) {
+		auto fields = report_fields(records.front());
+		std::vector<ReportField> header{};
+		for (const auto& field : fields) {
+			header.push_back({field.name, std::string(field.name)});
+		}
+		file << report_line(header, format) << '\n';
+	}
+	for (const auto& record : records) {
+		file << report_line(report_fields(record), format) << '\n';
+	}
+}
+
+std::unordered_map<std::string, std::chrono::nanoseconds> read_baseline(const std::string& path) {
+	std::ifstream file(path, std::ios::binary);
+	if (!file.is_open()) {
+		Logger::critical("Could not open file '{}'", path);
+	}
+	std::stringstream content;
+	content << file.rdbuf();
+
+	std::unordered_map<std::string, std::chrono::nanoseconds> baseline{};
+	for (const auto& record : read_raw_records(path, content.str())) {
+		auto key = report_key(
+			parse_number<int>(required_field(record, path, "year")),
+			parse_number<int>(required_field(record, path, "day")),
+			parse_number<int>(required_field(record, path, "part")),
+			required_field(record, path, "kind"),
+			required_field(record, path, "input"));
+		baseline[key] = std::chrono::nanoseconds(parse_number<int64_t>(required_field(record, path, "median_ns")));
+	}
+	return baseline;
+}
+
+std::vector<BaselineComparison> compare_to_baseline(const std::vector<ReportRecord>& records,
+	const std::unordered_map<std::string, std::chrono::nanoseconds>& baseline, double threshold) {
+	std::vector<BaselineComparison> comparisons{};
+	for (const auto& record : records) {
+		if (record.kind != "input") continue;
+
+		BaselineComparison comparison{&record};
+		auto it = baseline.find(record.key());
+		if (it != baseline.end()) {
+			comparison.baseline = it->second;
+			if (it->second.count() > 0) {
+				comparison.change = static_cast<double>(record.median.count()) / static_cast<double>(it->second.count()) - 1.0;
+			}
+			comparison.regressed = comparison.change * 100.0 > threshold;
+		}
+		comparisons.push_back(comparison);
+	}
+	return comparisons;
+}
@@ -0,0 +1,93 @@
+#ifndef REPORT_H
+#define REPORT_H
+
+#include <chrono>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Arena.h"
+#include "MemoryStats.h"
+#include "PerfCounters.h"
+
+/* ====================================================================================================
+ * Machine-Readable Results
+ */
+
+enum class ReportFormat {
+	/** one JSON object per line (JSON Lines) */
+	JSON,
+	/** header line followed by one line per record */
+	CSV,
+};
+
+/**
+ * Outcome of one test or input as written by write_report. Every record has the same columns;
+ * missing values are null (JSON) or empty (CSV).
+ */
+struct ReportRecord {
+	int year = 0;
+	int day = 0;
+	/** 0 if the Runner was not told the part */
+	int part = 0;
+	/** "test" or "input" */
+	std::string kind = "";
+	/** file name or the input string itself */
+	std::string input = "";
+	std::string result = "";
+	/** tests only */
+	std::optional<std::string> expected{};
+	std::optional<bool> passed{};
+
+	/** measured runs (1 outside of benchmark mode) */
+	size_t runs = 1;
+	unsigned warmup = 0;
+	/** statistics over the measured runs; all equal to the duration of a single run */
+	std::chrono::nanoseconds min{0};
+	std::chrono::nanoseconds median{0};
+	std::chrono::nanoseconds p90{0};
+	std::chrono::nanoseconds max{0};
+	std::chrono::nanoseconds mean{0};
+	std::chrono::nanoseconds stddev{0};
+	bool unstable = false;
+
+	std::optional<ArenaStats> arena{};
+	std::optional<MemoryStats> memory{};
+	std::optional<PerfStats> perf{};
+
+	/** identifies the record in a baseline: "year/day/part/kind/input" */
+	std::string key() const;
+};
+
+/**
+ * Appends the records to the file, writing the CSV header if the file is new or empty
+ * @throws 0xDEAD If the file could not be opened
+ */
+void write_report(const std::string& path, ReportFormat format, const std::vector<ReportRecord>& records);
+
+/**
+ * Reads the median times from a file written by write_report (JSON or CSV, detected by the content).
+ * Records that occur more than once (appended runs) take the value of the last one.
+ * @return median per ReportRecord::key()
+ * @throws 0xDEAD If the file could not be opened or is malformed
+ */
+std::unordered_map<std::string, std::chrono::nanoseconds> read_baseline(const std::string& path);
+
+struct BaselineComparison {
+	const ReportRecord* record;
+	/** empty if the baseline has no record for this input */
+	std::optional<std::chrono::nanoseconds> baseline{};
+	/** relative change of the median, 0.1 = 10% slower */
+	double change = 0.0;
+	bool regressed = false;
+};
+
+/**
+ * Compares the median times of all inputs (tests are skipped) against the baseline
+ * @param threshold allowed slowdown in percent before an input counts as regressed
+ */
+std::vector<BaselineComparison> compare_to_baseline(const std::vector<ReportRecord>& records,
+	const std::unordered_map<std::string, std::chrono::nanoseconds>& baseline, double threshold);
+
+#endif //REPORT_H
@@ -0,0 +1,273 @@
+#include "Scan.h"
+
+#include "utils.h"
+
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <random>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define SCAN_X86
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define SCAN_TARGET_AVX2
+#else
+#define SCAN_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+static void find_all_bytes_scalar(const char* data, size_t begin, size_t end, char c, std::vector<size_t>& offsets) {
+	for (size_t i = begin; i < end; ++i) {
+		if (data[i] == c) {
+			offsets.push_back(i);
+		}
+	}
+}
+
+template<typename Mask>
+static inline void push_mask(Mask mask, size_t base, std::vector<size_t>& offsets) {
+	while (mask != 0) {
+		offsets.push_back(base + std::countr_zero(mask));
+		mask &= mask - 1;
+	}
+}
+
+#ifdef SCAN_X86
+
+static void find_all_bytes_sse2(const char* data, size_t size, char c, std::vector<size_t>& offsets) {
+	const __m128i needle = _mm_set1_epi8(c);
+	size_t i = 0;
+	for (; i + 16 <= size; i += 16) {
+		const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+		const auto mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, needle)));
+		push_mask(mask, i, offsets);
+	}
+	find_all_bytes_scalar(data, i, size, c, offsets);
+}
+
+SCAN_TARGET_AVX2
+static void find_all_bytes_avx2(const char* data, size_t size, char c, std::vector<size_t>& offsets) {
+	const __m256i needle = _mm256_set1_epi8(c);
+	size_t i = 0;
+	for (; i + 64 <= size; i += 64) {
+		const __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+		const __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + 32));
+		const auto mask_lo = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, needle)));
+		const auto mask_hi = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, needle)));
+		push_mask(static_cast<uint64_t>(mask_hi) << 32 | mask_lo, i, offsets);
+	}
+	for (; i + 32 <= size; i += 32) {
+		const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+		push_mask(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, needle))), i, offsets);
+	}
+	find_all_bytes_scalar(data, i, size, c, offsets);
+}
+
+static size_t find_first_digit_sse2(const char* data, size_t pos, size_t size) {
+	const __m128i zero = _mm_set1_epi8('0');
+	const __m128i nine = _mm_set1_epi8(9);
+	for (; pos + 16 <= size; pos += 16) {
+		// c is a digit if (c - '0') as unsigned byte is at most 9
+		const __m128i offset = _mm_sub_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos)), zero);
+		const auto mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_min_epu8(offset, nine), offset)));
+		if (mask != 0) {
+			return pos + std::countr_zero(mask);
+		}
+	}
+	for (; pos < size; ++pos) {
+		if (static_cast<unsigned char>(data[pos] - '0') < 10) return pos;
+	}
+	return size;
+}
+
+SCAN_TARGET_AVX2
+static size_t find_first_digit_avx2(const char* data, size_t pos, size_t size) {
+	const __m256i zero = _mm256_set1_epi8('0');
+	const __m256i nine = _mm256_set1_epi8(9);
+	for (; pos + 32 <= size; pos += 32) {
+		const __m256i offset = _mm256_sub_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos)), zero);
+		const auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_min_epu8(offset, nine), offset)));
+		if (mask != 0) {
+			return pos + std::countr_zero(mask);
+		}
+	}
+	for (; pos < size; ++pos) {
+		if (static_cast<unsigned char>(data[pos] - '0') < 10) return pos;
+	}
+	return size;
+}
+
+static bool cpu_supports_avx2() {
+#if defined(_MSC_VER) && !defined(__clang__)
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] < 7) return false;
+	__cpuid(info, 1);
+	const bool os_xsave = (info[2] & (1 << 27)) != 0;
+	if (!os_xsave || (_xgetbv(0) & 0x6) != 0x6) return false;
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#else
+	return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif
+
+ScanLevel detected_scan_level() {
+#ifdef SCAN_X86
+	static const ScanLevel level = cpu_supports_avx2() ? ScanLevel::AVX2 : ScanLevel::SSE2;
+	return level;
+#else
+	return ScanLevel::SCALAR;
+#endif
+}
+
+// read by every solver thread in parallel mode; relaxed is enough since no other data depends on it
+static std::atomic<ScanLevel>& current_scan_level() {
+	static std::atomic<ScanLevel> level = detected_scan_level();
+	return level;
+}
+
+ScanLevel scan_level() {
+	return current_scan_level().load(std::memory_order_relaxed);
+}
+
+ScanLevel set_scan_level(ScanLevel level) {
+	const auto supported = detected_scan_level();
+	const auto used = static_cast<int>(level) > static_cast<int>(supported) ? supported : level;
+	current_scan_level().store(used, std::memory_order_relaxed);
+	return used;
+}
+
+const char* scan_level_name(ScanLevel level) {
+	switch (level) {
+		case ScanLevel::SCALAR: return "scalar";
+		case ScanLevel::SSE2: return "SSE2";
+		case ScanLevel::AVX2: return "AVX2";
+	}
+	return "unknown";
+}
+
+void find_all_bytes(std::string_view s, char c, std::vector<size_t>& offsets) {
+	switch (scan_level()) {
+#ifdef SCAN_X86
+		case ScanLevel::AVX2:
+			find_all_bytes_avx2(s.data(), s.size(), c, offsets);
+			return;
+		case ScanLevel::SSE2:
+			find_all_bytes_sse2(s.data(), s.size(), c, offsets);
+			return;
+#endif
+		default:
+			find_all_bytes_scalar(s.data(), 0, s.size(), c, offsets);
+			return;
+	}
+}
+
+size_t find_first_digit(std::string_view s, size_t pos) {
+	// most gaps between numbers are a few characters; only vectorise longer stretches
+	const size_t short_end = std::min(s.size(), pos + 8);
+	for (; pos < short_end; ++pos) {
+		if (static_cast<unsigned char>(s[pos] - '0') < 10) return pos;
+	}
+	if (pos >= s.size()) {
+		return s.size();
+	}
+
+	switch (scan_level()) {
+#ifdef SCAN_X86
+		case ScanLevel::AVX2:
+			return find_first_digit_avx2(s.data(), pos, s.size());
+		case ScanLevel::SSE2:
+			return find_first_digit_sse2(s.data(), pos, s.size());
+#endif
+		default:
+			for (; pos < s.size(); ++pos) {
+				if (static_cast<unsigned char>(s[pos] - '0') < 10) return pos;
+			}
+			return s.size();
+	}
+}
+
+std::vector<size_t> find_all_delims(std::string_view s, std::string_view delim) {
+	std::vector<size_t> offsets{};
+	if (delim.empty()) {
+		return offsets;
+	}
+
+	find_all_bytes(s, delim[0], offsets);
+	if (delim.size() == 1) {
+		return offsets;
+	}
+
+	// candidates only match the first byte; keep full, non-overlapping matches in place
+	size_t matches = 0;
+	size_t next_allowed = 0;
+	for (const size_t offset : offsets) {
+		if (offset < next_allowed || offset + delim.size() > s.size()) continue;
+		if (std::memcmp(s.data() + offset + 1, delim.data() + 1, delim.size() - 1) != 0) continue;
+		offsets[matches++] = offset;
+		next_allowed = offset + delim.size();
+	}
+	offsets.resize(matches);
+	return offsets;
+}
+
+void bench_scan(size_t size, unsigned runs) {
+	Logger::init();
+
+	// lines of 1 to 16 characters, similar to typical puzzle inputs
+	std::string input(size, 'x');
+	std::mt19937 rng(42);
+	for (size_t i = rng() % 16 + 1; i < size; i += rng() % 16 + 2) {
+		input[i] = '\n';
+	}
+
+	auto measure = [&](const char* name, auto fn) {
+		size_t found = 0;
+		const auto stats = time_runs(runs, [&] { found = fn(); });
+		const double gb_per_s = per_second(size, stats.median) / 1e9;
+		Logger::info("{:<24} {:>6.2f} GB/s (median {}, {} hits)", name, gb_per_s, format_time(stats.median), found);
+	};
+
+	Logger::info("Scanning {} MB, {} run(s) each", size >> 20, runs);
+
+	const auto previous = scan_level();
+	std::vector<size_t> offsets;
+	offsets.reserve(size / 8);
+	for (const auto level : {ScanLevel::SCALAR, ScanLevel::SSE2, ScanLevel::AVX2}) {
+		if (set_scan_level(level) != level) continue;
+		const auto name = fmt::format("find_all_bytes {}", scan_level_name(level));
+		measure(name.c_str(), [&] {
+			offsets.clear();
+			find_all_bytes(input, '\n', offsets);
+			return offsets.size();
+		});
+	}
+	set_scan_level(previous);
+
+	measure("memchr loop", [&] {
+		size_t count = 0;
+		const char* data = input.data();
+		const char* end = data + input.size();
+		while ((data = static_cast<const char*>(std::memchr(data, '\n', end - data))) != nullptr) {
+			++count;
+			++data;
+		}
+		return count;
+	});
+	measure("split_lines_view", [&] {
+		return split_lines_view(input).size();
+	});
+	measure("split_lines_range", [&] {
+		size_t count = 0;
+		for (auto line : split_lines_range(input)) {
+			count += !line.empty();
+		}
+		return count;
+	});
+}
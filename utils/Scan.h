@@ -0,0 +1,68 @@
+#ifndef SCAN_H
+#define SCAN_H
+
+#include <string_view>
+#include <vector>
+
+/* ====================================================================================================
+ * Byte Scanning
+ */
+enum class ScanLevel {
+	SCALAR,
+	SSE2,
+	AVX2
+};
+
+/**
+ * Best instruction set supported by the running CPU. Detected once on first use.
+ */
+ScanLevel detected_scan_level();
+
+/**
+ * Instruction set currently used by find_all_bytes (defaults to detected_scan_level())
+ */
+ScanLevel scan_level();
+
+/**
+ * Forces find_all_bytes to use the given instruction set. Levels that the CPU does not support
+ * fall back to the best supported one. Safe to call while other threads scan; they pick up the
+ * new level with their next call.
+ * @return level that is actually used
+ */
+ScanLevel set_scan_level(ScanLevel level);
+
+const char* scan_level_name(ScanLevel level);
+
+/**
+ * Appends the offset of every occurrence of c in s to offsets, scanning 16 (SSE2)
+ * or 64 (AVX2) bytes per step
+ * @param s string to be scanned
+ * @param c byte to search for
+ * @param offsets receives the offsets in ascending order
+ */
+void find_all_bytes(std::string_view s, char c, std::vector<size_t>& offsets);
+
+/**
+ * Index of the first digit in s at or after pos using SSE2/AVX2 (same dispatch as find_all_bytes)
+ * @return index or s.size() if there is none
+ */
+size_t find_first_digit(std::string_view s, size_t pos = 0);
+
+/**
+ * Offsets of every non-overlapping occurrence of delim in s from left to right
+ * (the same positions repeated std::string_view::find calls would return)
+ * @param s string to be scanned
+ * @param delim delimiter (can be longer than 1 char)
+ * @return offset index of the delimiters
+ */
+std::vector<size_t> find_all_delims(std::string_view s, std::string_view delim);
+
+/**
+ * Measures the throughput of find_all_bytes for every supported instruction set and of
+ * split_lines_view on a generated input and logs it in GB/s
+ * @param size size of the generated input in bytes
+ * @param runs measured runs per variant
+ */
+void bench_scan(size_t size = 256u << 20, unsigned runs = 5);
+
+#endif //SCAN_H
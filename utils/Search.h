@@ -0,0 +1,538 @@
+#ifndef SEARCH_H
+#define SEARCH_H
+
+#include <algorithm>
+#include <bit>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "FlatMap.h"
+#include "Grid.h"
+
+/* ====================================================================================================
+ * Search
+ *
+ * All searches work on implicit graphs:
+ *   neighbours(state, emit)   calls emit(next) (bfs) or emit(next, weight) (others) for every edge
+ *   goal(state)               stops the search when a popped state satisfies it (no_goal explores everything)
+ *   heuristic(state)          lower bound of the remaining cost (astar)
+ *
+ * Costs, visited states and optionally parents are kept in a storage that the caller can pass in
+ * to read all distances or the path afterwards:
+ *   HashSearchStorage<State, Cost, Parents>   FlatMap based, for any hashable state
+ *   IndexSearchStorage<...>                   dense arrays, e.g. grid_search_storage(grid) for Vec2i on a Grid
+ */
+
+template<typename State, typename Cost>
+struct SearchResult {
+	bool found = false;
+	/** cost of the goal (only valid if found) */
+	Cost cost{};
+	/** the state that satisfied the goal (only valid if found) */
+	State goal{};
+	/** number of states that were popped and expanded */
+	size_t expanded = 0;
+};
+
+/**
+ * Goal that is never reached: the search visits every reachable state
+ */
+inline constexpr auto no_goal = [](const auto&) { return false; };
+
+template<typename Cost>
+inline constexpr Cost SEARCH_UNSEEN = std::numeric_limits<Cost>::max();
+
+/**
+ * Costs (and parents) of visited states in a FlatMap
+ */
+template<typename State, typename Cost = int, bool Parents = false, typename Hash = FlatHash<State>>
+class HashSearchStorage {
+private:
+	struct NoParent {};
+	struct Entry {
+		Cost cost;
+		[[no_unique_address]] std::conditional_t<Parents, State, NoParent> parent;
+	};
+
+	FlatMap<State, Entry, Hash> entries{};
+
+public:
+	using state_type = State;
+	using cost_type = Cost;
+	static constexpr bool tracks_parents = Parents;
+
+	HashSearchStorage() = default;
+
+	/**
+	 * @param expected number of states the search is expected to visit
+	 */
+	explicit HashSearchStorage(size_t expected) : entries(expected) {}
+
+	Cost cost(const State& state) const {
+		auto it = entries.find(state);
+		return it == entries.end() ? SEARCH_UNSEEN<Cost> : it->second.cost;
+	}
+
+	bool visited(const State& state) const {
+		return entries.contains(state);
+	}
+
+	/**
+	 * Stores cost for state if it is lower than the known one
+	 * @return whether the state was updated
+	 */
+	bool relax(const State& state, Cost cost, const State& parent) {
+		auto [it, inserted] = entries.try_emplace(state);
+		if (!inserted && it->second.cost <= cost) {
+			return false;
+		}
+		it->second.cost = cost;
+		if constexpr (Parents) {
+			it->second.parent = parent;
+		}
+		return true;
+	}
+
+	State parent(const State& state) const requires Parents {
+		return entries.at(state).parent;
+	}
+
+	size_t size() const { return entries.size(); }
+
+	void clear() { entries.clear(); }
+
+	auto begin() const { return entries.begin(); }
+	auto end() const { return entries.end(); }
+};
+
+/**
+ * Costs (and parents) of visited states in arrays, for states that map to a dense index
+ * @tparam IndexFn size_t(const State&) returning an index below the size given to the constructor
+ */
+template<typename State, typename Cost, bool Parents, typename IndexFn>
+class IndexSearchStorage {
+private:
+	IndexFn index_fn;
+	std::vector<Cost> costs;
+	std::vector<State> parents{};
+	size_t visited_count = 0;
+
+public:
+	using state_type = State;
+	using cost_type = Cost;
+	static constexpr bool tracks_parents = Parents;
+
+	IndexSearchStorage(size_t size, IndexFn index_fn) : index_fn(std::move(index_fn)), costs(size, SEARCH_UNSEEN<Cost>) {
+		if constexpr (Parents) {
+			parents.resize(size);
+		}
+	}
+
+	Cost cost(const State& state) const {
+		return costs[index_fn(state)];
+	}
+
+	bool visited(const State& state) const {
+		return cost(state) != SEARCH_UNSEEN<Cost>;
+	}
+
+	bool relax(const State& state, Cost cost, const State& parent) {
+		const size_t index = index_fn(state);
+		if (costs[index] <= cost) {
+			return false;
+		}
+		visited_count += costs[index] == SEARCH_UNSEEN<Cost>;
+		costs[index] = cost;
+		if constexpr (Parents) {
+			parents[index] = parent;
+		}
+		return true;
+	}
+
+	State parent(const State& state) const requires Parents {
+		return parents[index_fn(state)];
+	}
+
+	size_t size() const { return visited_count; }
+
+	void clear() {
+		std::fill(costs.begin(), costs.end(), SEARCH_UNSEEN<Cost>);
+		visited_count = 0;
+	}
+};
+
+/**
+ * Maps positions of a Grid (padding included) to their index into the grid's buffer
+ */
+struct GridIndexFn {
+	int stride;
+	int padding;
+
+	size_t operator()(const Vec2i& p) const {
+		return static_cast<size_t>(p.y() + padding) * stride + (p.x() + padding);
+	}
+};
+
+/**
+ * Dense storage for searches over the positions of grid (the cells are not read)
+ */
+template<typename Cost = int, bool Parents = false, typename T>
+IndexSearchStorage<Vec2i, Cost, Parents, GridIndexFn> grid_search_storage(const Grid<T>& grid) {
+	const size_t size = static_cast<size_t>(grid.stride()) * (grid.height() + 2 * grid.padding());
+	return IndexSearchStorage<Vec2i, Cost, Parents, GridIndexFn>(size, GridIndexFn{grid.stride(), grid.padding()});
+}
+
+/**
+ * States from the start to state (both included); the storage has to track parents
+ */
+template<typename Storage>
+std::vector<typename Storage::state_type> search_path(const Storage& storage, typename Storage::state_type state) {
+	static_assert(Storage::tracks_parents, "search_path needs a storage with Parents = true");
+	std::vector<typename Storage::state_type> path{};
+	if (!storage.visited(state)) {
+		return path;
+	}
+	while (true) {
+		path.push_back(state);
+		auto parent = storage.parent(state);
+		if (parent == state) break;
+		state = parent;
+	}
+	std::reverse(path.begin(), path.end());
+	return path;
+}
+
+/**
+ * Largest ring dijkstra lets a BucketQueue grow to before it switches to a binary heap
+ */
+constexpr size_t BUCKET_QUEUE_MAX_SPAN = size_t(1) << 16;
+
+/**
+ * Monotone priority queue for integer priorities (Dial's algorithm): a ring of buckets covering
+ * [current, current + buckets). Pushing further ahead than the ring reaches grows it, pushing
+ * below current (not needed by dijkstra) moves the ring down. Only suited for small weights:
+ * the ring has to span the difference between the lowest and highest queued priority.
+ */
+template<typename State, typename Cost>
+class BucketQueue {
+	static_assert(std::is_integral_v<Cost>, "BucketQueue needs integer priorities");
+
+private:
+	std::vector<std::vector<State>> buckets;
+	Cost current = 0;
+	// upper bound of the queued priorities
+	Cost highest = 0;
+	size_t count = 0;
+
+public:
+	explicit BucketQueue(size_t span = 16) : buckets(std::bit_ceil(std::max<size_t>(span, 2))) {}
+
+	bool empty() const { return count == 0; }
+	size_t size() const { return count; }
+
+	/**
+	 * Number of buckets the ring needs (before rounding) once priority is pushed
+	 */
+	size_t span_for(Cost priority) const {
+		if (count == 0) {
+			return buckets.size();
+		}
+		if (priority < current) {
+			return std::max(static_cast<size_t>(highest - priority) + 1, buckets.size());
+		}
+		return std::max(static_cast<size_t>(priority - current) + 1, buckets.size());
+	}
+
+	void push(const State& state, Cost priority) {
+		if (count == 0) {
+			// the ring is empty and can start anywhere; keeping it where it is avoids moving it
+			// down again when the next push is lower
+			if (priority < current || static_cast<size_t>(priority - current) >= buckets.size()) {
+				current = priority;
+			}
+			highest = priority;
+		} else if (priority < current) {
+			rebucket(priority, std::max(static_cast<size_t>(highest - priority) + 1, buckets.size()));
+		} else if (static_cast<size_t>(priority - current) >= buckets.size()) {
+			rebucket(current, std::max(static_cast<size_t>(priority - current) + 1, buckets.size() * 2));
+		}
+		buckets[static_cast<size_t>(priority) & (buckets.size() - 1)].push_back(state);
+		highest = std::max(highest, priority);
+		++count;
+	}
+
+	/**
+	 * Removes an item with the lowest priority; the queue must not be empty
+	 */
+	std::pair<State, Cost> pop() {
+		const size_t mask = buckets.size() - 1;
+		while (buckets[static_cast<size_t>(current) & mask].empty()) {
+			++current;
+		}
+		auto& bucket = buckets[static_cast<size_t>(current) & mask];
+		State state = std::move(bucket.back());
+		bucket.pop_back();
+		--count;
+		return {std::move(state), current};
+	}
+
+private:
+	/**
+	 * Moves the ring to [base, base + span) (rounded up to a power of two); has to cover [current, highest]
+	 */
+	void rebucket(Cost base, size_t span) {
+		auto old = std::move(buckets);
+		const size_t old_mask = old.size() - 1;
+		buckets = std::vector<std::vector<State>>(std::bit_ceil(span));
+		const size_t mask = buckets.size() - 1;
+		for (size_t i = 0; i < old.size(); ++i) {
+			// the priority of bucket i is the one in [current, current + old.size()) that maps to i
+			const Cost priority = current + static_cast<Cost>((i - static_cast<size_t>(current)) & old_mask);
+			buckets[static_cast<size_t>(priority) & mask] = std::move(old[i]);
+		}
+		current = base;
+	}
+};
+
+/**
+ * Priority queue of dijkstra: a BucketQueue for integer costs as long as the weights stay small,
+ * a binary heap for other costs and once the ring would exceed BUCKET_QUEUE_MAX_SPAN
+ */
+template<typename State, typename Cost>
+class DijkstraQueue {
+private:
+	using Item = std::pair<Cost, State>;
+	struct Greater {
+		bool operator()(const Item& a, const Item& b) const { return a.first > b.first; }
+	};
+	using Heap = std::priority_queue<Item, std::vector<Item>, Greater>;
+
+	std::conditional_t<std::is_integral_v<Cost>, BucketQueue<State, Cost>, std::monostate> buckets{};
+	Heap heap{};
+	bool use_heap = !std::is_integral_v<Cost>;
+
+public:
+	bool empty() const {
+		if constexpr (std::is_integral_v<Cost>) {
+			if (!use_heap) return buckets.empty();
+		}
+		return heap.empty();
+	}
+
+	void push(const State& state, Cost priority) {
+		if constexpr (std::is_integral_v<Cost>) {
+			if (!use_heap && buckets.span_for(priority) <= BUCKET_QUEUE_MAX_SPAN) {
+				buckets.push(state, priority);
+				return;
+			}
+			if (!use_heap) {
+				while (!buckets.empty()) {
+					auto [queued, cost] = buckets.pop();
+					heap.emplace(cost, std::move(queued));
+				}
+				buckets = {};
+				use_heap = true;
+			}
+		}
+		heap.emplace(priority, state);
+	}
+
+	std::pair<State, Cost> pop() {
+		if constexpr (std::is_integral_v<Cost>) {
+			if (!use_heap) return buckets.pop();
+		}
+		auto [cost, state] = heap.top();
+		heap.pop();
+		return {std::move(state), cost};
+	}
+};
+
+/**
+ * Breadth-first search; every edge costs 1
+ * @param neighbours void(const State&, emit) calling emit(next)
+ */
+template<typename State, typename Neighbours, typename Goal, typename Storage>
+SearchResult<State, typename Storage::cost_type> bfs(const State& start, Neighbours&& neighbours, Goal&& goal, Storage& storage) {
+	using Cost = typename Storage::cost_type;
+	SearchResult<State, Cost> result{};
+
+	std::vector<State> frontier{start};
+	std::vector<State> next{};
+	storage.relax(start, 0, start);
+
+	for (Cost depth = 0; !frontier.empty(); ++depth) {
+		for (const auto& state : frontier) {
+			++result.expanded;
+			if (goal(state)) {
+				result.found = true;
+				result.cost = depth;
+				result.goal = state;
+				return result;
+			}
+			neighbours(state, [&](const State& neighbour) {
+				if (storage.relax(neighbour, depth + 1, state)) {
+					next.push_back(neighbour);
+				}
+			});
+		}
+		std::swap(frontier, next);
+		next.clear();
+	}
+	return result;
+}
+
+/**
+ * Shortest paths for edge weights of 0 and 1 with a deque
+ * @param neighbours void(const State&, emit) calling emit(next, weight) with weight 0 or 1
+ */
+template<typename State, typename Neighbours, typename Goal, typename Storage>
+SearchResult<State, typename Storage::cost_type> bfs01(const State& start, Neighbours&& neighbours, Goal&& goal, Storage& storage) {
+	using Cost = typename Storage::cost_type;
+	SearchResult<State, Cost> result{};
+
+	std::deque<std::pair<State, Cost>> queue{};
+	storage.relax(start, 0, start);
+	queue.emplace_back(start, 0);
+
+	while (!queue.empty()) {
+		auto [state, cost] = std::move(queue.front());
+		queue.pop_front();
+		if (cost > storage.cost(state)) continue;
+
+		++result.expanded;
+		if (goal(state)) {
+			result.found = true;
+			result.cost = cost;
+			result.goal = state;
+			return result;
+		}
+		neighbours(state, [&](const State& neighbour, Cost weight) {
+			if (storage.relax(neighbour, cost + weight, state)) {
+				if (weight == 0) {
+					queue.emplace_front(neighbour, cost);
+				} else {
+					queue.emplace_back(neighbour, cost + weight);
+				}
+			}
+		});
+	}
+	return result;
+}
+
+/**
+ * Dijkstra; integer costs use a BucketQueue while the weights are small, everything else a binary heap
+ * (see DijkstraQueue)
+ * @param neighbours void(const State&, emit) calling emit(next, weight) with weight >= 0
+ */
+template<typename State, typename Neighbours, typename Goal, typename Storage>
+SearchResult<State, typename Storage::cost_type> dijkstra(const State& start, Neighbours&& neighbours, Goal&& goal, Storage& storage) {
+	using Cost = typename Storage::cost_type;
+	SearchResult<State, Cost> result{};
+
+	DijkstraQueue<State, Cost> queue{};
+	storage.relax(start, 0, start);
+	queue.push(start, Cost{0});
+
+	while (!queue.empty()) {
+		auto [state, cost] = queue.pop();
+		if (cost > storage.cost(state)) continue;
+
+		++result.expanded;
+		if (goal(state)) {
+			result.found = true;
+			result.cost = cost;
+			result.goal = state;
+			return result;
+		}
+		neighbours(state, [&](const State& neighbour, Cost weight) {
+			if (storage.relax(neighbour, cost + weight, state)) {
+				queue.push(neighbour, cost + weight);
+			}
+		});
+	}
+	return result;
+}
+
+/**
+ * A* with a binary heap ordered by cost + heuristic
+ * @param neighbours void(const State&, emit) calling emit(next, weight) with weight >= 0
+ * @param heuristic Cost(const State&); admissible (never overestimates), consistent heuristics
+ *                  expand every state at most once
+ */
+template<typename State, typename Neighbours, typename Goal, typename Heuristic, typename Storage>
+SearchResult<State, typename Storage::cost_type> astar(const State& start, Neighbours&& neighbours, Goal&& goal,
+	Heuristic&& heuristic, Storage& storage) {
+	using Cost = typename Storage::cost_type;
+	SearchResult<State, Cost> result{};
+
+	struct Item {
+		Cost estimate;
+		Cost cost;
+		State state;
+	};
+	// ties prefer the deeper item, which is usually closer to the goal
+	auto greater = [](const Item& a, const Item& b) {
+		return a.estimate > b.estimate || (a.estimate == b.estimate && a.cost < b.cost);
+	};
+	std::priority_queue<Item, std::vector<Item>, decltype(greater)> queue(greater);
+
+	storage.relax(start, 0, start);
+	queue.push(Item{heuristic(start), 0, start});
+
+	while (!queue.empty()) {
+		auto [estimate, cost, state] = queue.top();
+		queue.pop();
+		if (cost > storage.cost(state)) continue;
+
+		++result.expanded;
+		if (goal(state)) {
+			result.found = true;
+			result.cost = cost;
+			result.goal = state;
+			return result;
+		}
+		neighbours(state, [&](const State& neighbour, Cost weight) {
+			const Cost next_cost = cost + weight;
+			if (storage.relax(neighbour, next_cost, state)) {
+				queue.push(Item{next_cost + heuristic(neighbour), next_cost, neighbour});
+			}
+		});
+	}
+	return result;
+}
+
+/*
+ * Overloads with an internal HashSearchStorage<State, Cost> when only the result is needed
+ */
+
+template<typename Cost = int, typename State, typename Neighbours, typename Goal>
+SearchResult<State, Cost> bfs(const State& start, Neighbours&& neighbours, Goal&& goal) {
+	HashSearchStorage<State, Cost> storage{};
+	return bfs(start, neighbours, goal, storage);
+}
+
+template<typename Cost = int, typename State, typename Neighbours, typename Goal>
+SearchResult<State, Cost> bfs01(const State& start, Neighbours&& neighbours, Goal&& goal) {
+	HashSearchStorage<State, Cost> storage{};
+	return bfs01(start, neighbours, goal, storage);
+}
+
+template<typename Cost = int, typename State, typename Neighbours, typename Goal>
+SearchResult<State, Cost> dijkstra(const State& start, Neighbours&& neighbours, Goal&& goal) {
+	HashSearchStorage<State, Cost> storage{};
+	return dijkstra(start, neighbours, goal, storage);
+}
+
+template<typename Cost = int, typename State, typename Neighbours, typename Goal, typename Heuristic>
+SearchResult<State, Cost> astar(const State& start, Neighbours&& neighbours, Goal&& goal, Heuristic&& heuristic) {
+	HashSearchStorage<State, Cost> storage{};
+	return astar(start, neighbours, goal, heuristic, storage);
+}
+
+#endif //SEARCH_H
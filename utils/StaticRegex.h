@@ -0,0 +1,567 @@
+#ifndef STATICREGEX_H
+#define STATICREGEX_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string_view>
+
+/**
+ * String literal usable as template argument: StaticRegex<"(\\d+)">
+ */
+template<size_t N>
+struct FixedString {
+	char data[N] {};
+
+	constexpr FixedString(const char (&s)[N]) {
+		std::copy_n(s, N, data);
+	}
+
+	constexpr size_t size() const { return N - 1; }
+	constexpr char operator[](size_t i) const { return data[i]; }
+	constexpr std::string_view view() const { return {data, N - 1}; }
+};
+
+/* ====================================================================================================
+ * Compile-time pattern parsing
+ *
+ * Supported (ECMAScript subset): literals, escapes (\d \w \s \D \W \S \n \r \t and escaped
+ * punctuation), '.', [classes] with ranges and negation, (captures), (?:groups), alternation '|',
+ * quantifiers * + ? {n} {n,} {n,m} with lazy '?' suffix, anchors ^ $.
+ * Unsupported syntax fails to compile.
+ */
+namespace static_regex_detail {
+	enum class NodeKind : uint8_t {
+		EMPTY,
+		CHAR,
+		ANY,
+		CLASS,
+		SEQ,
+		ALT,
+		REPEAT,
+		CAPTURE,
+		BEGIN,
+		END
+	};
+
+	/**
+	 * CHAR: a = character
+	 * CLASS: a = class index
+	 * SEQ/ALT: a = offset of the first child in Program::children, b = number of children
+	 * REPEAT: a = child node, b = min, c = max (-1 for unbounded)
+	 * CAPTURE: a = child node, b = capture index
+	 */
+	struct Node {
+		NodeKind kind = NodeKind::EMPTY;
+		int a = 0;
+		int b = 0;
+		int c = 0;
+		bool greedy = true;
+	};
+
+	struct CharClass {
+		uint64_t bits[4] {};
+
+		constexpr void set(unsigned char c) { bits[c >> 6] |= uint64_t(1) << (c & 63); }
+		constexpr bool test(unsigned char c) const { return (bits[c >> 6] >> (c & 63)) & 1; }
+
+		constexpr void set_range(unsigned char from, unsigned char to) {
+			for (int c = from; c <= to; ++c) set(static_cast<unsigned char>(c));
+		}
+
+		constexpr void merge(const CharClass& other, bool negate) {
+			for (int i = 0; i < 4; ++i) bits[i] |= negate ? ~other.bits[i] : other.bits[i];
+		}
+
+		constexpr void invert() {
+			for (auto& word : bits) word = ~word;
+		}
+	};
+
+	constexpr CharClass digit_class() {
+		CharClass c;
+		c.set_range('0', '9');
+		return c;
+	}
+
+	constexpr CharClass word_class() {
+		CharClass c;
+		c.set_range('0', '9');
+		c.set_range('a', 'z');
+		c.set_range('A', 'Z');
+		c.set('_');
+		return c;
+	}
+
+	constexpr CharClass space_class() {
+		CharClass c;
+		for (char s : {' ', '\t', '\n', '\r', '\v', '\f'}) c.set(static_cast<unsigned char>(s));
+		return c;
+	}
+
+	template<size_t N>
+	struct Program {
+		static constexpr size_t MAX_NODES = 2 * N + 4;
+
+		Node nodes[MAX_NODES] {};
+		int node_count = 0;
+		int children[MAX_NODES] {};
+		int child_count = 0;
+		CharClass classes[N + 1] {};
+		int class_count = 0;
+		int capture_count = 0;
+		int root = 0;
+	};
+
+	template<size_t N>
+	class Parser {
+	private:
+		const char* pattern;
+		size_t len;
+		size_t pos = 0;
+
+	public:
+		Program<N> program {};
+
+		constexpr Parser(const char* pattern, size_t len) : pattern(pattern), len(len) {}
+
+		constexpr void parse() {
+			program.root = parse_alt();
+			if (pos != len) throw "StaticRegex: unbalanced ')'";
+		}
+
+	private:
+		constexpr bool at_end() const { return pos >= len; }
+		constexpr char peek() const { return pattern[pos]; }
+
+		constexpr int add(Node node) {
+			if (program.node_count >= static_cast<int>(Program<N>::MAX_NODES)) throw "StaticRegex: pattern too complex";
+			program.nodes[program.node_count] = node;
+			return program.node_count++;
+		}
+
+		constexpr int add_list(NodeKind kind, const int* items, int count) {
+			const int first = program.child_count;
+			for (int i = 0; i < count; ++i) {
+				program.children[program.child_count++] = items[i];
+			}
+			return add(Node{kind, first, count});
+		}
+
+		constexpr int add_class(const CharClass& c) {
+			program.classes[program.class_count] = c;
+			return add(Node{NodeKind::CLASS, program.class_count++});
+		}
+
+		constexpr int parse_alt() {
+			int alternatives[Program<N>::MAX_NODES] {};
+			int count = 0;
+			alternatives[count++] = parse_seq();
+			while (!at_end() && peek() == '|') {
+				++pos;
+				alternatives[count++] = parse_seq();
+			}
+			return count == 1 ? alternatives[0] : add_list(NodeKind::ALT, alternatives, count);
+		}
+
+		constexpr int parse_seq() {
+			int items[Program<N>::MAX_NODES] {};
+			int count = 0;
+			while (!at_end() && peek() != '|' && peek() != ')') {
+				items[count++] = parse_repeat();
+			}
+			return count == 1 ? items[0] : add_list(NodeKind::SEQ, items, count);
+		}
+
+		constexpr int parse_number() {
+			if (at_end() || peek() < '0' || peek() > '9') throw "StaticRegex: expected number in {}";
+			int n = 0;
+			while (!at_end() && peek() >= '0' && peek() <= '9') {
+				n = n * 10 + (pattern[pos++] - '0');
+			}
+			return n;
+		}
+
+		constexpr int parse_repeat() {
+			int atom = parse_atom();
+			while (!at_end()) {
+				int min = 0;
+				int max = -1;
+				const char c = peek();
+				if (c == '*') {
+					++pos;
+				} else if (c == '+') {
+					min = 1;
+					++pos;
+				} else if (c == '?') {
+					max = 1;
+					++pos;
+				} else if (c == '{') {
+					++pos;
+					min = max = parse_number();
+					if (!at_end() && peek() == ',') {
+						++pos;
+						max = !at_end() && peek() == '}' ? -1 : parse_number();
+					}
+					if (at_end() || pattern[pos++] != '}') throw "StaticRegex: expected '}'";
+					if (max != -1 && max < min) throw "StaticRegex: invalid range in {}";
+				} else {
+					break;
+				}
+
+				bool greedy = true;
+				if (!at_end() && peek() == '?') {
+					greedy = false;
+					++pos;
+				}
+				atom = add(Node{NodeKind::REPEAT, atom, min, max, greedy});
+			}
+			return atom;
+		}
+
+		/**
+		 * Parses the character after a '\\'
+		 * @param c receives the class of the escape (for \d, \w, ...) or the single literal character
+		 */
+		constexpr void parse_escape(CharClass& c) {
+			if (at_end()) throw "StaticRegex: pattern ends with '\\'";
+			const char e = pattern[pos++];
+			switch (e) {
+				case 'd': c.merge(digit_class(), false); return;
+				case 'D': c.merge(digit_class(), true); return;
+				case 'w': c.merge(word_class(), false); return;
+				case 'W': c.merge(word_class(), true); return;
+				case 's': c.merge(space_class(), false); return;
+				case 'S': c.merge(space_class(), true); return;
+				case 'n': c.set('\n'); return;
+				case 'r': c.set('\r'); return;
+				case 't': c.set('\t'); return;
+				case 'f': c.set('\f'); return;
+				case 'v': c.set('\v'); return;
+				default:
+					if ((e >= 'a' && e <= 'z') || (e >= 'A' && e <= 'Z') || (e >= '0' && e <= '9')) {
+						throw "StaticRegex: unsupported escape";
+					}
+					c.set(static_cast<unsigned char>(e));
+			}
+		}
+
+		constexpr int parse_class() {
+			CharClass c;
+			bool negate = false;
+			if (!at_end() && peek() == '^') {
+				negate = true;
+				++pos;
+			}
+			while (!at_end() && peek() != ']') {
+				if (peek() == '\\') {
+					++pos;
+					parse_escape(c);
+					continue;
+				}
+				const auto from = static_cast<unsigned char>(pattern[pos++]);
+				if (pos + 1 < len && peek() == '-' && pattern[pos + 1] != ']') {
+					++pos;
+					const auto to = static_cast<unsigned char>(pattern[pos++]);
+					if (to < from) throw "StaticRegex: invalid range in []";
+					c.set_range(from, to);
+				} else {
+					c.set(from);
+				}
+			}
+			if (at_end()) throw "StaticRegex: expected ']'";
+			++pos;
+			if (negate) c.invert();
+			return add_class(c);
+		}
+
+		constexpr int parse_atom() {
+			const char c = pattern[pos++];
+			switch (c) {
+				case '(': {
+					int capture = -1;
+					if (pos + 1 < len && peek() == '?' && pattern[pos + 1] == ':') {
+						pos += 2;
+					} else if (!at_end() && peek() == '?') {
+						throw "StaticRegex: only (?:) groups are supported";
+					} else {
+						capture = program.capture_count++;
+					}
+					const int child = parse_alt();
+					if (at_end() || pattern[pos++] != ')') throw "StaticRegex: expected ')'";
+					return capture < 0 ? child : add(Node{NodeKind::CAPTURE, child, capture});
+				}
+				case '[':
+					return parse_class();
+				case '.':
+					return add(Node{NodeKind::ANY});
+				case '^':
+					return add(Node{NodeKind::BEGIN});
+				case '$':
+					return add(Node{NodeKind::END});
+				case '\\': {
+					CharClass escaped;
+					parse_escape(escaped);
+					const char e = pattern[pos - 1];
+					const bool is_class = e == 'd' || e == 'D' || e == 'w' || e == 'W' || e == 's' || e == 'S';
+					if (is_class) return add_class(escaped);
+					for (int ch = 0; ch < 256; ++ch) {
+						if (escaped.test(static_cast<unsigned char>(ch))) return add(Node{NodeKind::CHAR, ch});
+					}
+					throw "StaticRegex: invalid escape";
+				}
+				case '*':
+				case '+':
+				case '?':
+				case '{':
+					throw "StaticRegex: quantifier without preceding atom";
+				case ')':
+					throw "StaticRegex: unbalanced ')'";
+				default:
+					return add(Node{NodeKind::CHAR, static_cast<unsigned char>(c)});
+			}
+		}
+	};
+
+	template<FixedString Pattern>
+	constexpr auto compile() {
+		Parser<Pattern.size()> parser(Pattern.data, Pattern.size());
+		parser.parse();
+		return parser.program;
+	}
+}
+
+/* ====================================================================================================
+ * Matching
+ */
+
+/**
+ * Regex whose pattern is parsed at compile time. Every node of the pattern becomes its own
+ * function template, so the compiler generates a backtracking matcher specialized for the
+ * pattern (same semantics as std::regex with ECMAScript syntax).
+ * @tparam Pattern regex pattern
+ */
+template<FixedString Pattern>
+class StaticRegex {
+private:
+	using NodeKind = static_regex_detail::NodeKind;
+
+	static constexpr auto program = static_regex_detail::compile<Pattern>();
+
+public:
+	static constexpr size_t capture_count = program.capture_count;
+
+	/**
+	 * [0] is the whole match, [i] the i-th capture (empty if the capture did not participate)
+	 */
+	using Match = std::array<std::string_view, capture_count + 1>;
+
+	/**
+	 * Matches the whole string like std::regex_match
+	 */
+	static std::optional<Match> match(std::string_view s) {
+		State state{s.data(), s.data() + s.size()};
+		const bool matched = match_node<program.root>(state.begin, state, [&](const char* it) {
+			return it == state.end;
+		});
+		if (!matched) return std::nullopt;
+		return to_match(state, state.begin, state.end);
+	}
+
+	/**
+	 * Finds the first match at or after pos like std::regex_search
+	 */
+	static std::optional<Match> search(std::string_view s, size_t pos = 0) {
+		State state{s.data(), s.data() + s.size()};
+		const char* match_end = nullptr;
+		auto record_end = [&](const char* it) {
+			match_end = it;
+			return true;
+		};
+
+		constexpr int leading = leading_char(program.root);
+		for (const char* start = state.begin + std::min(pos, s.size()); start <= state.end; ++start) {
+			if constexpr (leading >= 0) {
+				start = static_cast<const char*>(std::memchr(start, leading, state.end - start));
+				if (start == nullptr) return std::nullopt;
+			}
+			if (match_node<program.root>(start, state, record_end)) {
+				return to_match(state, start, match_end);
+			}
+		}
+		return std::nullopt;
+	}
+
+private:
+	struct Capture {
+		const char* begin = nullptr;
+		const char* end = nullptr;
+	};
+
+	struct State {
+		const char* begin;
+		const char* end;
+		std::array<Capture, capture_count> captures {};
+	};
+
+	static Match to_match(const State& state, const char* begin, const char* end) {
+		Match result {};
+		result[0] = std::string_view(begin, end - begin);
+		for (size_t i = 0; i < capture_count; ++i) {
+			const auto& capture = state.captures[i];
+			if (capture.begin != nullptr) {
+				result[i + 1] = std::string_view(capture.begin, capture.end - capture.begin);
+			}
+		}
+		return result;
+	}
+
+	/**
+	 * Character every match has to start with or -1. Lets search() skip ahead with memchr.
+	 */
+	static constexpr int leading_char(int i) {
+		const auto& node = program.nodes[i];
+		switch (node.kind) {
+			case NodeKind::CHAR: return node.a;
+			case NodeKind::SEQ: return node.b > 0 ? leading_char(program.children[node.a]) : -1;
+			case NodeKind::CAPTURE: return leading_char(node.a);
+			case NodeKind::REPEAT: return node.b > 0 ? leading_char(node.a) : -1;
+			default: return -1;
+		}
+	}
+
+	static constexpr bool is_single_char(int i) {
+		const auto kind = program.nodes[i].kind;
+		return kind == NodeKind::CHAR || kind == NodeKind::ANY || kind == NodeKind::CLASS;
+	}
+
+	template<int I>
+	static bool test_char(char c) {
+		constexpr auto node = program.nodes[I];
+		if constexpr (node.kind == NodeKind::CHAR) {
+			return c == static_cast<char>(node.a);
+		} else if constexpr (node.kind == NodeKind::ANY) {
+			return c != '\n' && c != '\r';
+		} else {
+			return program.classes[node.a].test(static_cast<unsigned char>(c));
+		}
+	}
+
+	template<int I, typename Cont>
+	static bool match_node(const char* it, State& state, const Cont& cont) {
+		constexpr auto node = program.nodes[I];
+
+		if constexpr (is_single_char(I)) {
+			return it != state.end && test_char<I>(*it) && cont(it + 1);
+		} else if constexpr (node.kind == NodeKind::EMPTY) {
+			return cont(it);
+		} else if constexpr (node.kind == NodeKind::BEGIN) {
+			return it == state.begin && cont(it);
+		} else if constexpr (node.kind == NodeKind::END) {
+			return it == state.end && cont(it);
+		} else if constexpr (node.kind == NodeKind::SEQ) {
+			return match_seq<I, 0>(it, state, cont);
+		} else if constexpr (node.kind == NodeKind::ALT) {
+			return match_alt<I, 0>(it, state, cont);
+		} else if constexpr (node.kind == NodeKind::CAPTURE) {
+			return match_capture<I>(it, state, cont);
+		} else if constexpr (is_single_char(node.a)) {
+			return match_repeat_char<I>(it, state, cont);
+		} else {
+			return match_repeat<I>(it, 0, state, cont);
+		}
+	}
+
+	template<int I, int K, typename Cont>
+	static bool match_seq(const char* it, State& state, const Cont& cont) {
+		constexpr auto node = program.nodes[I];
+		if constexpr (K == node.b) {
+			return cont(it);
+		} else {
+			return match_node<program.children[node.a + K]>(it, state, [&](const char* next) {
+				return match_seq<I, K + 1>(next, state, cont);
+			});
+		}
+	}
+
+	template<int I, int K, typename Cont>
+	static bool match_alt(const char* it, State& state, const Cont& cont) {
+		constexpr auto node = program.nodes[I];
+		if constexpr (K == node.b) {
+			return false;
+		} else {
+			return match_node<program.children[node.a + K]>(it, state, cont)
+				|| match_alt<I, K + 1>(it, state, cont);
+		}
+	}
+
+	template<int I, typename Cont>
+	static bool match_capture(const char* it, State& state, const Cont& cont) {
+		constexpr auto node = program.nodes[I];
+		return match_node<node.a>(it, state, [&](const char* next) {
+			const auto previous = state.captures[node.b];
+			state.captures[node.b] = Capture{it, next};
+			if (cont(next)) return true;
+			state.captures[node.b] = previous;
+			return false;
+		});
+	}
+
+	/**
+	 * Repetition of a single character: counts the run once, then backtracks
+	 * over its length without recursion
+	 */
+	template<int I, typename Cont>
+	static bool match_repeat_char(const char* it, State& state, const Cont& cont) {
+		constexpr auto node = program.nodes[I];
+		const size_t available = state.end - it;
+		const size_t max = node.c < 0 ? available : std::min<size_t>(node.c, available);
+		size_t n = 0;
+		while (n < max && test_char<node.a>(it[n])) {
+			++n;
+		}
+		if (n < static_cast<size_t>(node.b)) return false;
+
+		if constexpr (node.greedy) {
+			for (size_t k = n + 1; k-- > static_cast<size_t>(node.b);) {
+				if (cont(it + k)) return true;
+			}
+		} else {
+			for (size_t k = node.b; k <= n; ++k) {
+				if (cont(it + k)) return true;
+			}
+		}
+		return false;
+	}
+
+	template<int I, typename Cont>
+	static bool match_repeat(const char* it, int count, State& state, const Cont& cont) {
+		constexpr auto node = program.nodes[I];
+		auto match_more = [&]() {
+			if (node.c >= 0 && count >= node.c) return false;
+			return match_node<node.a>(it, state, [&](const char* next) {
+				// an empty iteration cannot make progress once min is reached
+				if (next == it && count >= node.b) return false;
+				return match_repeat<I>(next, count + 1, state, cont);
+			});
+		};
+
+		if (count < node.b) return match_more();
+		if constexpr (node.greedy) {
+			return match_more() || cont(it);
+		} else {
+			return cont(it) || match_more();
+		}
+	}
+};
+
+/**
+ * Compile-time regex object for extract_data & co.:
+ * extract_data<int, std::string>(line, ct_regex<"(\\d+) (\\w+)">)
+ */
+template<FixedString Pattern>
+inline constexpr StaticRegex<Pattern> ct_regex {};
+
+#endif //STATICREGEX_H
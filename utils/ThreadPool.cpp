@@ -0,0 +1,109 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <utility>
+
+ThreadPool::ThreadPool(unsigned threads) {
+	if (threads == 0) {
+		threads = std::max(1u, std::thread::hardware_concurrency());
+	}
+
+	for (unsigned i = 0; i < threads; ++i) {
+		queues.push_back(std::make_unique<Queue>());
+	}
+	for (unsigned i = 0; i < threads; ++i) {
+		workers.emplace_back([this, i] { worker_loop(i); });
+	}
+}
+
+ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard lock(state_mutex);
+		stopping = true;
+	}
+	wake.notify_all();
+	for (auto& worker : workers) {
+		worker.join();
+	}
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+	unsigned index;
+	{
+		std::lock_guard lock(state_mutex);
+		index = next_queue++ % queues.size();
+		++pending;
+	}
+	{
+		std::lock_guard lock(queues[index]->mutex);
+		queues[index]->tasks.push_back(std::move(task));
+	}
+	{
+		// counted under the state mutex so a worker about to sleep cannot miss it
+		std::lock_guard lock(state_mutex);
+		++queued;
+	}
+	wake.notify_one();
+}
+
+void ThreadPool::wait() {
+	std::unique_lock lock(state_mutex);
+	idle.wait(lock, [this] { return pending == 0; });
+	if (error != nullptr) {
+		std::rethrow_exception(std::exchange(error, nullptr));
+	}
+}
+
+bool ThreadPool::try_pop(unsigned index, std::function<void()>& task) {
+	{
+		auto& own = *queues[index];
+		std::lock_guard lock(own.mutex);
+		if (!own.tasks.empty()) {
+			task = std::move(own.tasks.front());
+			own.tasks.pop_front();
+			return true;
+		}
+	}
+
+	for (size_t offset = 1; offset < queues.size(); ++offset) {
+		auto& victim = *queues[(index + offset) % queues.size()];
+		std::lock_guard lock(victim.mutex);
+		if (!victim.tasks.empty()) {
+			task = std::move(victim.tasks.front());
+			victim.tasks.pop_front();
+			return true;
+		}
+	}
+	return false;
+}
+
+void ThreadPool::worker_loop(unsigned index) {
+	while (true) {
+		std::function<void()> task;
+		if (try_pop(index, task)) {
+			--queued;
+			std::exception_ptr task_error = nullptr;
+			try {
+				task();
+			} catch (...) {
+				task_error = std::current_exception();
+			}
+
+			std::lock_guard lock(state_mutex);
+			if (task_error != nullptr && error == nullptr) {
+				error = std::move(task_error);
+			}
+			task_error = nullptr;
+			if (--pending == 0) {
+				idle.notify_all();
+			}
+			continue;
+		}
+
+		std::unique_lock lock(state_mutex);
+		wake.wait(lock, [this] { return stopping || queued > 0; });
+		if (stopping && queued == 0) {
+			return;
+		}
+	}
+}
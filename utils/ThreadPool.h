@@ -0,0 +1,114 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <variant>
+#include <vector>
+
+/**
+ * Fixed-size work-stealing thread pool. Every worker owns a deque; it takes its own work
+ * from the front and steals from the front of the other deques when it runs dry. Tasks run
+ * roughly in submission order, which lets run_ordered report early items while later ones still run.
+ */
+class ThreadPool {
+private:
+	struct Queue {
+		std::mutex mutex;
+		std::deque<std::function<void()>> tasks;
+	};
+
+	std::vector<std::unique_ptr<Queue>> queues;
+	std::vector<std::thread> workers;
+
+	std::mutex state_mutex;
+	std::condition_variable wake;
+	std::condition_variable idle;
+	std::atomic<size_t> queued = 0;
+	size_t pending = 0;
+	unsigned next_queue = 0;
+	bool stopping = false;
+	std::exception_ptr error = nullptr;
+
+public:
+	/**
+	 * @param threads number of workers; 0 uses std::thread::hardware_concurrency()
+	 */
+	explicit ThreadPool(unsigned threads = 0);
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	unsigned size() const { return static_cast<unsigned>(workers.size()); }
+
+	void submit(std::function<void()> task);
+
+	/**
+	 * Blocks until every submitted task has finished
+	 * @throws the first exception thrown by a task
+	 */
+	void wait();
+
+private:
+	bool try_pop(unsigned index, std::function<void()>& task);
+	void worker_loop(unsigned index);
+};
+
+/**
+ * Evaluates count items on the pool and reports them in index order: report(i, outcome) runs on the
+ * calling thread as soon as item i and all items before it are done.
+ * @param evaluate outcome of item i; runs on the workers
+ * @param report consumes the outcome of item i; runs on the calling thread
+ * @throws the exception of the first item (in index order) whose evaluation threw, after all items have finished
+ */
+template<typename Evaluate, typename Report>
+void run_ordered(ThreadPool& pool, size_t count, Evaluate evaluate, Report report) {
+	using Outcome = std::invoke_result_t<Evaluate&, size_t>;
+	using Slot = std::variant<Outcome, std::exception_ptr>;
+
+	std::vector<std::optional<Slot>> outcomes(count);
+	std::mutex mutex;
+	std::condition_variable finished;
+
+	for (size_t i = 0; i < count; ++i) {
+		pool.submit([&, i] {
+			std::optional<Slot> slot{};
+			try {
+				slot.emplace(std::in_place_index<0>, evaluate(i));
+			} catch (...) {
+				slot.emplace(std::in_place_index<1>, std::current_exception());
+			}
+			{
+				std::lock_guard lock(mutex);
+				outcomes[i] = std::move(slot);
+			}
+			finished.notify_all();
+		});
+	}
+
+	for (size_t i = 0; i < count; ++i) {
+		std::unique_lock lock(mutex);
+		finished.wait(lock, [&] { return outcomes[i].has_value(); });
+		auto slot = std::move(*outcomes[i]);
+		lock.unlock();
+		if (slot.index() == 1) {
+			// the remaining tasks still reference mutex and outcomes
+			pool.wait();
+			std::rethrow_exception(std::get<1>(slot));
+		}
+		report(i, std::get<0>(slot));
+	}
+
+	pool.wait();
+}
+
+#endif //THREADPOOL_H
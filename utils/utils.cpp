@@ -53,6 +53,24 @@ std::string trim(std::string s) {
 	return s;
 }
 
+/**
+ * trims whitespace (recognized using
+ * std::isspace()) from both ends of the string without copying it
+ * @param s string to be trimmed
+ * @return view of the trimmed part of s
+ */
+std::string_view trim_view(std::string_view s) {
+	size_t start = 0;
+	while (start < s.size() && std::isspace(static_cast<unsigned char>(s[start]))) {
+		++start;
+	}
+	size_t end = s.size();
+	while (end > start && std::isspace(static_cast<unsigned char>(s[end - 1]))) {
+		--end;
+	}
+	return s.substr(start, end - start);
+}
+
 std::string replace_all(const std::string& str, const std::string& pattern, const std::string& replace) {
 	size_t n = 0;
 	std::string str_cpy = str;
@@ -114,30 +132,43 @@ std::optional<std::string> replace_nth(const std::string& str, const std::string
  * @return content
  * @throws 0xDEAD If file could not be found or opened
  */
-std::string read_file(const std::string& filename) {
+std::filesystem::path resolve_input_path(const std::string& filename) {
 	auto dir_name = std::filesystem::current_path().filename().string();
 	dir_name = dir_name.substr(dir_name.size() - 2);
 	auto cwd = std::filesystem::current_path() / "../../../" / "src" / dir_name;
 	cwd = std::filesystem::canonical(cwd);
-	auto file = std::ifstream(cwd / filename, std::ios::binary | std::ios::in);
-    if (!file.is_open()) {
+	auto path = cwd / filename;
+	if (!std::filesystem::is_regular_file(path)) {
 		Logger::critical("Failed to open file '{}'. CWD: {}", filename, cwd.string());
-    }
+	}
+	return path;
+}
 
-	std::stringstream contents;
-	contents << file.rdbuf();
+std::string read_file(const std::string& filename) {
+	return std::string(read_input(filename).view());
+}
 
-	return replace_all(contents.str(), "\r\n", "\n");
+InputBuffer read_input(const std::string& filename) {
+	return InputBuffer::map_file(resolve_input_path(filename));
 }
 
-std::vector<std::string> split_lines(const std::string& s) {
-	std::vector<std::string> result;
-	std::stringstream ss(s);
-	std::string line;
-	while (std::getline(ss, line)) {
-		line.erase(std::remove(line.begin(), line.end(), '\r'), line.end());
-		result.emplace_back(line);
+template<typename Lines>
+static void copy_lines(std::string_view s, Lines& result) {
+	for (auto line : split_lines_range(s)) {
+		auto& copy = result.emplace_back(line);
+		copy.erase(std::remove(copy.begin(), copy.end(), '\r'), copy.end());
 	}
+}
+
+std::vector<std::string> split_lines(std::string_view s) {
+	std::vector<std::string> result;
+	copy_lines(s, result);
+	return result;
+}
+
+std::pmr::vector<std::pmr::string> split_lines(std::string_view s, std::pmr::memory_resource* memory) {
+	std::pmr::vector<std::pmr::string> result(memory);
+	copy_lines(s, result);
 	return result;
 }
 
@@ -146,38 +177,144 @@ std::vector<std::string> split_lines(const std::string& s) {
  */
 
 
+static std::string_view strip_cr(std::string_view line) {
+	if (!line.empty() && line.back() == '\r') {
+		line.remove_suffix(1);
+	}
+	return line;
+}
+
+SplitRange::Iterator::Iterator(std::string_view s, std::string_view delim, bool lines)
+	: s(s), delim(delim), pos(0), lines(lines), done(false) {
+	if (delim.empty()) {
+		Logger::critical("`split` received an empty delimiter");
+	}
+	if (!lines && trim_view(s).empty()) {
+		done = true;
+		return;
+	}
+	advance();
+}
+
+void SplitRange::Iterator::advance() {
+	if (pos == std::string_view::npos) {
+		done = true;
+		return;
+	}
+
+	std::string_view part;
+	const auto idx = delim.size() == 1 ? s.find(delim[0], pos) : s.find(delim, pos);
+	if (idx == std::string_view::npos) {
+		part = s.substr(pos);
+		pos = std::string_view::npos;
+		// like std::getline a trailing newline does not start another line
+		if (lines && part.empty()) {
+			done = true;
+			return;
+		}
+	} else {
+		part = s.substr(pos, idx - pos);
+		pos = idx + delim.size();
+	}
+
+	if (lines) {
+		current = strip_cr(part);
+	} else {
+		current = trim_view(part);
+	}
+}
+
+SplitRange split_range(std::string_view s, std::string_view delim) {
+	return SplitRange(s, delim, false);
+}
+
+SplitRange split_lines_range(std::string_view s) {
+	return SplitRange(s, "\n", true);
+}
+
 /**
  *	Splits a given string at the given delimiter and trims the parts
  *	@param s string to be split
  *	@param delim delimiter (can be longer than 1 char)
  */
-std::vector<std::string> split(const std::string& s, const std::string& delim) {
+std::vector<std::string> split(std::string_view s, std::string_view delim) {
+	std::vector<std::string> parts{};
+	for (auto part : split_view(s, delim)) {
+		parts.emplace_back(part);
+	}
+	return parts;
+}
+
+std::pmr::vector<std::pmr::string> split(std::string_view s, std::string_view delim, std::pmr::memory_resource* memory) {
+	std::pmr::vector<std::pmr::string> parts(memory);
+	for (auto part : split_view(s, delim, memory)) {
+		parts.emplace_back(part);
+	}
+	return parts;
+}
+
+template<typename Parts>
+static void split_view_into(std::string_view s, std::string_view delim, Parts& parts) {
 	if (delim.empty()) {
 		Logger::critical("`split` received an empty delimiter");
-		return {};
 	}
-	if (trim(s).empty()) {
-		return {};
+	if (trim_view(s).empty()) {
+		return;
 	}
 
-	size_t lastDelim = 0;
-	auto curDelim = s.find(delim, lastDelim);
-	std::vector<std::string> parts{};
+	const auto offsets = find_all_delims(s, delim);
+	parts.reserve(offsets.size() + 1);
 
-	while (curDelim != std::string::npos) {
-		std::string part = s.substr(lastDelim, curDelim - lastDelim);
-		parts.emplace_back(trim(part));
-		lastDelim = curDelim + delim.size();
-		curDelim = s.find(delim, lastDelim);
+	size_t last = 0;
+	for (const size_t offset : offsets) {
+		parts.push_back(trim_view(s.substr(last, offset - last)));
+		last = offset + delim.size();
 	}
+	parts.push_back(trim_view(s.substr(last)));
+}
 
-	auto lastPart = s.substr(lastDelim);
-	parts.emplace_back(trim(lastPart));
+std::vector<std::string_view> split_view(std::string_view s, std::string_view delim) {
+	std::vector<std::string_view> parts{};
+	split_view_into(s, delim, parts);
+	return parts;
+}
 
+std::pmr::vector<std::string_view> split_view(std::string_view s, std::string_view delim, std::pmr::memory_resource* memory) {
+	std::pmr::vector<std::string_view> parts(memory);
+	split_view_into(s, delim, parts);
 	return parts;
 }
 
-std::vector<int> split_int(const std::string& s, const std::string& delim) {
+template<typename Lines>
+static void split_lines_into(std::string_view s, Lines& lines) {
+	std::vector<size_t> offsets{};
+	find_all_bytes(s, '\n', offsets);
+	lines.reserve(offsets.size() + 1);
+
+	size_t last = 0;
+	for (const size_t offset : offsets) {
+		lines.push_back(strip_cr(s.substr(last, offset - last)));
+		last = offset + 1;
+	}
+	// like std::getline a trailing newline does not start another line
+	if (last < s.size()) {
+		lines.push_back(strip_cr(s.substr(last)));
+	}
+}
+
+std::vector<std::string_view> split_lines_view(std::string_view s) {
+	std::vector<std::string_view> lines{};
+	split_lines_into(s, lines);
+	return lines;
+}
+
+std::pmr::vector<std::string_view> split_lines_view(std::string_view s, std::pmr::memory_resource* memory) {
+	std::pmr::vector<std::string_view> lines(memory);
+	split_lines_into(s, lines);
+	return lines;
+}
+
+std::vector<int> split_int(std::string_view s, std::string_view delim) {
 	return split<int>(s, delim);
 }
 
@@ -187,9 +324,14 @@ std::vector<int> split_int(const std::string& s, const std::string& delim) {
  *	@param delim delimiter (can be longer than 1 char)
  *	@param fn converts parts after splitting using this function
  */
-std::pair<std::string, std::string> split_once(const std::string& s, const std::string& delim) {
+std::pair<std::string, std::string> split_once(std::string_view s, std::string_view delim) {
+	const auto [first, second] = split_once_view(s, delim);
+	return {std::string(first), std::string(second)};
+}
+
+std::pair<std::string_view, std::string_view> split_once_view(std::string_view s, std::string_view delim) {
 	auto idx = s.find(delim);
-	if (idx == std::string::npos) {
+	if (idx == std::string_view::npos) {
 		Logger::critical("Failed split_once");
 	}
 
@@ -261,6 +403,9 @@ std::string format_time(std::chrono::duration<std::chrono::nanoseconds::rep, std
 	const char* names[] = {" ns", " μs ", " ms ", " s ", " min ", " h ", " d "};
 
 	auto rest = duration.count();
+	if (rest == 0) {
+		return "0 ns";
+	}
 	int i = 0;
 	while (rest != 0 && i < 7) {
 		result.insert(0, std::to_string(rest % lengths[i]) + names[i]);
@@ -273,6 +418,144 @@ std::string format_time(std::chrono::duration<std::chrono::nanoseconds::rep, std
 	return result;
 }
 
+std::string format_bytes(size_t bytes) {
+	const char* units[] = {"KiB", "MiB", "GiB", "TiB"};
+	if (bytes < 1024) {
+		return fmt::format("{} B", bytes);
+	}
+	double value = static_cast<double>(bytes) / 1024.0;
+	int unit = 0;
+	while (value >= 1024.0 && unit < 3) {
+		value /= 1024.0;
+		unit++;
+	}
+	return fmt::format("{:.1f} {}", value, units[unit]);
+}
+
+void record_phase(std::vector<PhaseTiming>& phases, const char* name, std::chrono::nanoseconds duration, size_t count) {
+	for (auto& phase : phases) {
+		if (phase.name == name || std::strcmp(phase.name, name) == 0) {
+			phase.duration += duration;
+			phase.count += count;
+			return;
+		}
+	}
+	phases.push_back(PhaseTiming{name, duration, count});
+}
+
+std::string format_phases(const std::vector<PhaseTiming>& phases, std::chrono::nanoseconds total, size_t runs) {
+	std::string result = "";
+	for (const auto& phase : phases) {
+		if (!result.empty()) {
+			result += " | ";
+		}
+		const double percent = total.count() == 0 ? 0.0 : 100.0 * phase.duration.count() / total.count();
+		result += fmt::format("{} {} ({:.1f}%)", phase.name, format_time(phase.duration / static_cast<int64_t>(std::max<size_t>(runs, 1))), percent);
+	}
+	return result;
+}
+
+/**
+ * Computes min/median/p90/max, mean and (sample) standard deviation of the given durations
+ * @param samples measured durations - order does not matter
+ * @return statistics; all zero if samples is empty
+ */
+TimingStats compute_timing_stats(std::vector<std::chrono::nanoseconds> samples) {
+	TimingStats stats{};
+	stats.samples = samples.size();
+	if (samples.empty()) {
+		return stats;
+	}
+
+	std::sort(samples.begin(), samples.end());
+	const size_t n = samples.size();
+
+	stats.min = samples.front();
+	stats.max = samples.back();
+	stats.median = n % 2 == 1 ? samples[n / 2] : (samples[n / 2 - 1] + samples[n / 2]) / 2;
+	// nearest-rank percentile
+	stats.p90 = samples[static_cast<size_t>(std::ceil(0.9 * n)) - 1];
+
+	double sum = 0.0;
+	for (const auto& sample : samples) {
+		sum += static_cast<double>(sample.count());
+	}
+	const double mean = sum / n;
+	stats.mean = std::chrono::nanoseconds(static_cast<int64_t>(mean));
+
+	if (n > 1) {
+		double sq_sum = 0.0;
+		for (const auto& sample : samples) {
+			const double diff = static_cast<double>(sample.count()) - mean;
+			sq_sum += diff * diff;
+		}
+		stats.stddev = std::chrono::nanoseconds(static_cast<int64_t>(std::sqrt(sq_sum / (n - 1))));
+	}
+
+	return stats;
+}
+
+static unsigned parse_flag_value(const std::string& arg, size_t prefix_len) {
+	try {
+		return static_cast<unsigned>(std::stoul(arg.substr(prefix_len)));
+	} catch (const std::exception&) {
+		Logger::critical("Invalid value in argument '{}'", arg);
+	}
+}
+
+RunnerOptions parse_runner_options(int argc, char** argv, RunnerOptions options) {
+	const bool configured = options.bench_runs > 0;
+	bool bench = false;
+	std::optional<unsigned> runs{};
+	std::optional<unsigned> warmup{};
+
+	for (int i = 1; i < argc; ++i) {
+		const std::string arg = argv[i];
+		if (arg == "--bench") {
+			bench = true;
+		} else if (arg.starts_with("--runs=")) {
+			runs = parse_flag_value(arg, 7);
+		} else if (arg.starts_with("--warmup=")) {
+			warmup = parse_flag_value(arg, 9);
+		} else if (arg == "--no-phases") {
+			options.phases = false;
+		} else if (arg == "--no-arena") {
+			options.arena = false;
+		} else if (arg == "--memory") {
+			options.memory = true;
+		} else if (arg == "--perf") {
+			options.perf = true;
+		} else if (arg.starts_with("--json=")) {
+			options.report_path = arg.substr(7);
+			options.report_format = ReportFormat::JSON;
+		} else if (arg.starts_with("--csv=")) {
+			options.report_path = arg.substr(6);
+			options.report_format = ReportFormat::CSV;
+		} else if (arg.starts_with("--baseline=")) {
+			options.baseline_path = arg.substr(11);
+		} else if (arg.starts_with("--threshold=")) {
+			options.regression_threshold = parse_number<double>(std::string_view(arg).substr(12));
+		} else if (arg == "--parallel") {
+			options.parallel = true;
+		} else if (arg.starts_with("--threads=")) {
+			options.parallel = true;
+			options.threads = parse_flag_value(arg, 10);
+		} else {
+			Logger::warn("Ignoring unknown argument '{}'", arg);
+		}
+	}
+
+	if (bench || runs.has_value() || warmup.has_value()) {
+		if (runs == 0u) {
+			Logger::critical("Benchmark mode needs at least one measured run (--runs=0)");
+		}
+		options.bench_runs = runs.value_or(configured ? options.bench_runs : DEFAULT_BENCH_RUNS);
+		options.bench_warmup = warmup.value_or(configured ? options.bench_warmup : DEFAULT_BENCH_WARMUP);
+	}
+
+	return options;
+}
+
 std::vector<size_t> find_all_idx(const std::string& s, const std::string& pattern) {
 	std::vector<size_t> idxs{};
 	size_t last_idx = s.find(pattern);
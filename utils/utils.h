@@ -19,9 +19,33 @@
 #include <functional>
 #include <sstream>
 #include <numeric>
+#include <optional>
+#include <chrono>
+#include <cstring>
+#include <charconv>
+#include <atomic>
 
 #include <Logger.h>
 
+#include "InputBuffer.h"
+#include "Scan.h"
+#include "ThreadPool.h"
+#include "Arena.h"
+#include "MemoryStats.h"
+#include "PerfCounters.h"
+#include "Report.h"
+#include "Hash.h"
+#include "FlatMap.h"
+#include "StaticRegex.h"
+#include "Grid.h"
+#include "BitGrid.h"
+#include "Search.h"
+#include "Cycle.h"
+#include "Memo.h"
+#include "ModInt.h"
+#include "Rational.h"
+#include "DynMatrix.h"
+
 #include "Matrix.h"
 
 
@@ -40,12 +64,14 @@ using NamedTable = std::unordered_map<Key, std::unordered_map<Key, Value>>;
 struct Point {
 	int x;
 	int y;
+
+	bool operator==(const Point& other) const = default;
 };
 
 template<>
 struct std::hash<Point> {
 	size_t operator()(const Point& point) const {
-		return static_cast<size_t>(point.x) ^ (static_cast<size_t>(point.y) << 32);
+		return hash_pair32(static_cast<uint32_t>(point.x), static_cast<uint32_t>(point.y));
 	}
 };
 
@@ -82,6 +108,14 @@ std::string repeat(char c, int n);
  */
 std::string trim(std::string s);
 
+/**
+ * trims whitespace (recognized using
+ * std::isspace()) from both ends of the string without copying it
+ * @param s string to be trimmed
+ * @return view of the trimmed part of s
+ */
+std::string_view trim_view(std::string_view s);
+
 std::string replace_all(const std::string& str, const std::string& pattern, const std::string& replace);
 std::string replace_regex(const std::string& str, const std::regex& pattern, const char* replace);
 std::string replace_regex_all(const std::string& str, const std::regex& pattern, const char* replace);
@@ -94,6 +128,13 @@ std::optional<std::string> replace_nth(const std::string& str, const std::string
 /* ====================================================================================================
  * Reading Data
  */
+/**
+ * Resolves the filename relative to the source directory of the current day
+ * @param filename
+ * @return absolute path
+ */
+std::filesystem::path resolve_input_path(const std::string& filename);
+
 /**
  * Reads file
  * @param filename
@@ -102,7 +143,20 @@ std::optional<std::string> replace_nth(const std::string& str, const std::string
  */
 std::string read_file(const std::string& filename);
 
-std::vector<std::string> split_lines(const std::string& s);
+/**
+ * Memory-maps file without copying it. Line endings are normalised to "\n"
+ * @param filename
+ * @return buffer viewing the content
+ * @throws 0xDEAD If file could not be found or opened
+ */
+InputBuffer read_input(const std::string& filename);
+
+std::vector<std::string> split_lines(std::string_view s);
+
+/**
+ * Same lines as split_lines(), allocated from memory (e.g. run_memory())
+ */
+std::pmr::vector<std::pmr::string> split_lines(std::string_view s, std::pmr::memory_resource* memory);
 
 /* ====================================================================================================
  * Printing Data
@@ -174,6 +228,55 @@ T string_to_generic(std::string s) {
 	return T();
 }
 
+/**
+ * Parses a number like std::stoi & co. (leading whitespace and '+' are skipped, trailing characters ignored)
+ * but without locale, exceptions or a std::string temporary
+ * @param s string starting with the number
+ * @return parsed number
+ * @throws 0xDEAD If s does not start with a number or the number is out of range
+ */
+template<typename T> requires (std::is_arithmetic_v<T>)
+T parse_number(std::string_view s) {
+	size_t start = 0;
+	while (start < s.size() && std::isspace(static_cast<unsigned char>(s[start]))) {
+		++start;
+	}
+	if (start < s.size() && s[start] == '+') {
+		++start;
+	}
+
+	T value{};
+	const auto [ptr, ec] = std::from_chars(s.data() + start, s.data() + s.size(), value);
+	if (ec != std::errc()) {
+		Logger::critical("Failed to parse '{}' as number", s);
+	}
+	return value;
+}
+
+/**
+ * string_view overload: numbers are parsed with std::from_chars without copying.
+ * Other types fall back to the std::string version, so specializing that one is enough.
+ */
+template<typename T>
+T string_to_generic(std::string_view s) {
+	if constexpr (std::is_same_v<T, std::string_view>) {
+		return s;
+	} else if constexpr (std::is_same_v<T, std::string>) {
+		return std::string(s);
+	} else if constexpr (std::is_same_v<T, char>) {
+		return s[0];
+	} else if constexpr (std::is_arithmetic_v<T> && !std::is_same_v<T, bool>) {
+		return parse_number<T>(s);
+	} else {
+		return string_to_generic<T>(std::string(s));
+	}
+}
+
+template<typename T>
+T string_to_generic(const char* s) {
+	return string_to_generic<T>(std::string_view(s));
+}
+
 template<>
 inline std::string string_to_generic<std::string>(std::string s) {
 	return s;
@@ -181,17 +284,17 @@ inline std::string string_to_generic<std::string>(std::string s) {
 
 template<>
 inline int string_to_generic<int>(std::string s) {
-	return std::stoi(s);
+	return parse_number<int>(s);
 }
 
 template<>
 inline long string_to_generic<long>(std::string s) {
-	return std::stol(s);
+	return parse_number<long>(s);
 }
 
 template<>
 inline double string_to_generic<double>(std::string s) {
-	return std::stod(s);
+	return parse_number<double>(s);
 }
 
 template<>
@@ -200,16 +303,140 @@ inline char string_to_generic<char>(std::string s) {
 }
 template<>
 inline long long string_to_generic<long long>(std::string s) {
-	return std::stoll(s);
+	return parse_number<long long>(s);
 }
 
+/**
+ * Appends every integer in s (a '-' directly in front of the digits makes it negative) to out
+ * in a single pass without regex or temporaries. Non-digit stretches are skipped with SIMD.
+ * @param s string to be scanned
+ * @param out receives the numbers in order
+ */
+template<typename T = int, typename Alloc> requires (std::is_integral_v<T>)
+void extract_ints(std::string_view s, std::vector<T, Alloc>& out) {
+	using U = std::make_unsigned_t<T>;
+	size_t i = find_first_digit(s, 0);
+	while (i < s.size()) {
+		const bool negative = std::is_signed_v<T> && i > 0 && s[i - 1] == '-';
+		U value = 0;
+		while (i < s.size() && static_cast<unsigned char>(s[i] - '0') < 10) {
+			value = value * 10 + static_cast<U>(s[i] - '0');
+			++i;
+		}
+		out.push_back(negative ? static_cast<T>(U(0) - value) : static_cast<T>(value));
+		i = find_first_digit(s, i);
+	}
+}
+
+template<typename T = int> requires (std::is_integral_v<T>)
+std::vector<T> extract_ints(std::string_view s) {
+	std::vector<T> result{};
+	extract_ints<T>(s, result);
+	return result;
+}
+
+/**
+ * Same numbers as extract_ints(s), allocated from memory (e.g. run_memory())
+ */
+template<typename T = int> requires (std::is_integral_v<T>)
+std::pmr::vector<T> extract_ints(std::string_view s, std::pmr::memory_resource* memory) {
+	std::pmr::vector<T> result(memory);
+	extract_ints<T>(s, result);
+	return result;
+}
+
+/**
+ * Lazy range over the parts of a string. Yields views into the original string, so
+ * iterating it allocates nothing. Created by split_range() and split_lines_range().
+ */
+class SplitRange {
+public:
+	class Iterator {
+	private:
+		std::string_view s;
+		std::string_view delim;
+		std::string_view current;
+		size_t pos;
+		bool lines;
+		bool done;
+
+	public:
+		using value_type = std::string_view;
+		using difference_type = std::ptrdiff_t;
+
+		Iterator() : pos(std::string_view::npos), lines(false), done(true) {}
+		Iterator(std::string_view s, std::string_view delim, bool lines);
+
+		std::string_view operator*() const { return current; }
+
+		Iterator& operator++() {
+			advance();
+			return *this;
+		}
+
+		Iterator operator++(int) {
+			auto copy = *this;
+			advance();
+			return copy;
+		}
+
+		bool operator==(std::default_sentinel_t) const { return done; }
+
+	private:
+		void advance();
+	};
+
+private:
+	std::string_view s;
+	std::string_view delim;
+	bool lines;
+
+public:
+	SplitRange(std::string_view s, std::string_view delim, bool lines) : s(s), delim(delim), lines(lines) {}
+
+	Iterator begin() const { return Iterator(s, delim, lines); }
+	std::default_sentinel_t end() const { return {}; }
+};
+
+/**
+ *	Lazily splits a given string at the given delimiter and trims the parts. Same parts as split()
+ *	@param s string to be split - must outlive the range
+ *	@param delim delimiter (can be longer than 1 char) - must outlive the range
+ */
+SplitRange split_range(std::string_view s, std::string_view delim);
+
+/**
+ *	Lazily splits a given string into lines (without '\r'). Same lines as split_lines()
+ *	@param s string to be split - must outlive the range
+ */
+SplitRange split_lines_range(std::string_view s);
 
 /**
  *	Splits a given string at the given delimiter and trims the parts
  *	@param s string to be split
  *	@param delim delimiter (can be longer than 1 char)
  */
-std::vector<std::string> split(const std::string& s, const std::string& delim);
+std::vector<std::string> split(std::string_view s, std::string_view delim);
+
+/**
+ *	Same parts as split(s, delim), allocated from memory (e.g. run_memory())
+ */
+std::pmr::vector<std::pmr::string> split(std::string_view s, std::string_view delim, std::pmr::memory_resource* memory);
+
+/**
+ *	Splits a given string at the given delimiter and trims the parts without copying them
+ *	@param s string to be split - must outlive the result
+ *	@param delim delimiter (can be longer than 1 char)
+ */
+std::vector<std::string_view> split_view(std::string_view s, std::string_view delim);
+std::pmr::vector<std::string_view> split_view(std::string_view s, std::string_view delim, std::pmr::memory_resource* memory);
+
+/**
+ *	Splits a given string into lines (without '\r') without copying them
+ *	@param s string to be split - must outlive the result
+ */
+std::vector<std::string_view> split_lines_view(std::string_view s);
+std::pmr::vector<std::string_view> split_lines_view(std::string_view s, std::pmr::memory_resource* memory);
 
 /**
  *	Splits a given string at the given delimiter and trims the parts before converting them using the given function.
@@ -218,28 +445,24 @@ std::vector<std::string> split(const std::string& s, const std::string& delim);
  *	@param fn converts parts after splitting using this function
  */
 template<typename T>
-std::vector<T> split(const std::string& s, const std::string& delim, std::function<T(std::string)> fn) {
-	auto splitted = split(s, delim);
+std::vector<T> split(std::string_view s, std::string_view delim, std::function<T(std::string)> fn) {
 	auto result = std::vector<T>();
-	result.reserve(splitted.size());
-	for (auto str : splitted) {
-		result.emplace_back(fn(str));
+	for (auto str : split_range(s, delim)) {
+		result.emplace_back(fn(std::string(str)));
 	}
 	return result;
 }
 
 template<typename T>
-std::vector<T> split(const std::string& s, const std::string& delim) {
-	auto splitted = split(s, delim);
+std::vector<T> split(std::string_view s, std::string_view delim) {
 	auto result = std::vector<T>();
-	result.reserve(splitted.size());
-	for (auto str : splitted) {
+	for (auto str : split_range(s, delim)) {
 		result.emplace_back(string_to_generic<T>(str));
 	}
 	return result;
 }
 
-std::vector<int> split_int(const std::string& s, const std::string& delim);
+std::vector<int> split_int(std::string_view s, std::string_view delim);
 
 /**
  *	Splits a given string at the first occurrence of the given delimiter and returns both parts as pair
@@ -247,31 +470,30 @@ std::vector<int> split_int(const std::string& s, const std::string& delim);
  *	@param delim delimiter (can be longer than 1 char)
  *	@param fn converts parts after splitting using this function
  */
-std::pair<std::string, std::string> split_once(const std::string& s, const std::string& delim);
+std::pair<std::string, std::string> split_once(std::string_view s, std::string_view delim);
 
-template<typename T, typename U>
-std::pair<T, U> split_once(const std::string& s, const std::string& delim) {
-	auto idx = s.find(delim);
-	if (idx == std::string::npos) {
-		Logger::critical("Failed split_once");
-	}
+/**
+ *	Splits a given string at the first occurrence of the given delimiter without copying the parts
+ *	@param s string to be split - must outlive the result
+ *	@param delim delimiter (can be longer than 1 char)
+ */
+std::pair<std::string_view, std::string_view> split_once_view(std::string_view s, std::string_view delim);
 
+template<typename T, typename U>
+std::pair<T, U> split_once(std::string_view s, std::string_view delim) {
+	const auto [first, second] = split_once_view(s, delim);
 	return {
-		string_to_generic<T>(s.substr(0, idx)),
-		string_to_generic<U>(s.substr(idx + delim.size()))
+		string_to_generic<T>(first),
+		string_to_generic<U>(second)
 	};
 }
 
 template<typename T>
-std::pair<T, T> split_once(const std::string& s, const std::string& delim, std::function<T(std::string)> fn) {
-	auto idx = s.find(delim);
-	if (idx == std::string::npos) {
-		Logger::critical("Failed split_once");
-	}
-
+std::pair<T, T> split_once(std::string_view s, std::string_view delim, std::function<T(std::string)> fn) {
+	const auto [first, second] = split_once_view(s, delim);
 	return {
-		fn(s.substr(0, idx)),
-		fn(s.substr(idx + delim.size()))
+		fn(std::string(first)),
+		fn(std::string(second))
 	};
 }
 
@@ -295,9 +517,12 @@ T min(T t, U u) {
 	return t < u ? t : u;
 }
 
-template<typename... Args, std::size_t... Indices>
-std::tuple<Args...> make_tuple_from_match(const std::smatch& match, std::index_sequence<Indices...>) {
-	return std::make_tuple<Args...>(string_to_generic<Args>(match[Indices + 1].str())...);
+typedef std::match_results<std::string_view::const_iterator> svmatch;
+typedef std::regex_iterator<std::string_view::const_iterator> svregex_iterator;
+
+template<typename... Args, typename Match, std::size_t... Indices>
+std::tuple<Args...> make_tuple_from_match(const Match& match, std::index_sequence<Indices...>) {
+	return std::make_tuple<Args...>(string_to_generic<Args>(std::string_view(match[Indices + 1].first, match[Indices + 1].second))...);
 }
 
 /**
@@ -308,9 +533,9 @@ std::tuple<Args...> make_tuple_from_match(const std::smatch& match, std::index_s
  * @return tuple of the converted matches
  */
 template<typename... Args>
-std::tuple<Args...> extract_data(std::string s, const std::regex& pattern) {
-	std::smatch match;
-	if (!std::regex_match(s, match, pattern)) {
+std::tuple<Args...> extract_data(std::string_view s, const std::regex& pattern) {
+	svmatch match;
+	if (!std::regex_match(s.begin(), s.end(), match, pattern)) {
 		Logger::critical("Failed to match regex for '{}'", s);
 	}
 
@@ -318,12 +543,12 @@ std::tuple<Args...> extract_data(std::string s, const std::regex& pattern) {
 }
 
 template<typename... Args>
-std::vector<std::tuple<Args...>> extract_data_all(std::string s, const std::regex& pattern) {
-	std::sregex_iterator iter(s.begin(), s.end(), pattern);
-	std::sregex_iterator end;
+std::vector<std::tuple<Args...>> extract_data_all(std::string_view s, const std::regex& pattern) {
+	svregex_iterator iter(s.begin(), s.end(), pattern);
+	svregex_iterator end;
 	std::vector<std::tuple<Args...>> result{};
 	while (iter != end) {
-		std::smatch match = *iter;
+		const svmatch& match = *iter;
 		result.push_back(make_tuple_from_match<Args...>(match, std::index_sequence_for<Args...>{}));
 		++iter;
 	}
@@ -332,15 +557,272 @@ std::vector<std::tuple<Args...>> extract_data_all(std::string s, const std::rege
 }
 
 template<typename... Args>
-std::optional<std::tuple<Args...>> extract_data_opt(std::string s, const std::regex& pattern) {
-	std::smatch match;
-	if (!std::regex_match(s, match, pattern)) {
+std::optional<std::tuple<Args...>> extract_data_opt(std::string_view s, const std::regex& pattern) {
+	svmatch match;
+	if (!std::regex_match(s.begin(), s.end(), match, pattern)) {
 		return std::nullopt;
 	}
 
 	return make_tuple_from_match<Args...>(match, std::index_sequence_for<Args...>{});
 }
 
+template<typename... Args, typename Match, std::size_t... Indices>
+std::tuple<Args...> make_tuple_from_views(const Match& match, std::index_sequence<Indices...>) {
+	return std::make_tuple<Args...>(string_to_generic<Args>(match[Indices + 1])...);
+}
+
+/**
+ * Extracts data from a given string using a compile-time regex and converts the captures to the given types
+ * @tparam Args Types of the captures. A template specialization of string_to_generic must be provided
+ * @param s	string to be matched
+ * @param pattern compile-time regex, e.g. ct_regex<"(\\d+) (\\w+)">
+ * @return tuple of the converted captures
+ */
+template<typename... Args, FixedString Pattern>
+std::tuple<Args...> extract_data(std::string_view s, StaticRegex<Pattern> pattern) {
+	static_assert(sizeof...(Args) <= StaticRegex<Pattern>::capture_count, "More types than captures in pattern");
+	const auto match = pattern.match(s);
+	if (!match) {
+		Logger::critical("Failed to match regex for '{}'", s);
+	}
+
+	return make_tuple_from_views<Args...>(*match, std::index_sequence_for<Args...>{});
+}
+
+template<typename... Args, FixedString Pattern>
+std::vector<std::tuple<Args...>> extract_data_all(std::string_view s, StaticRegex<Pattern> pattern) {
+	static_assert(sizeof...(Args) <= StaticRegex<Pattern>::capture_count, "More types than captures in pattern");
+	std::vector<std::tuple<Args...>> result{};
+	size_t pos = 0;
+	while (pos <= s.size()) {
+		const auto match = pattern.search(s, pos);
+		if (!match) break;
+		result.push_back(make_tuple_from_views<Args...>(*match, std::index_sequence_for<Args...>{}));
+
+		const auto& whole = (*match)[0];
+		pos = (whole.data() - s.data()) + std::max<size_t>(whole.size(), 1);
+	}
+
+	return result;
+}
+
+template<typename... Args, FixedString Pattern>
+std::optional<std::tuple<Args...>> extract_data_opt(std::string_view s, StaticRegex<Pattern> pattern) {
+	static_assert(sizeof...(Args) <= StaticRegex<Pattern>::capture_count, "More types than captures in pattern");
+	const auto match = pattern.match(s);
+	if (!match) {
+		return std::nullopt;
+	}
+
+	return make_tuple_from_views<Args...>(*match, std::index_sequence_for<Args...>{});
+}
+
+/* ====================================================================================================
+ * Format Scanning
+ */
+
+/**
+ * Format string for scan(): literal text with one "{}" per field, "{{" and "}}" match single braces.
+ * Parsed and checked against the field types at compile time (like std::format_string).
+ *
+ * Fields are matched without backtracking:
+ *  - numbers are read as far as std::from_chars gets (a leading '+' or '-' is allowed)
+ *  - char fields take exactly one character
+ *  - all other fields (std::string_view, std::string, custom types) extend to the first occurrence
+ *    of the following literal; the last field extends to the final literal at the end of the string
+ */
+template<typename... Args>
+class ScanFormat {
+public:
+	struct Literal {
+		size_t offset = 0;
+		size_t raw_length = 0;
+		size_t length = 0;
+		bool escaped = false;
+	};
+
+	static constexpr size_t field_count = sizeof...(Args);
+
+private:
+	std::string_view format;
+	std::array<Literal, field_count + 1> literals{};
+
+	template<typename T>
+	static constexpr bool is_number = std::is_arithmetic_v<T> && !std::is_same_v<T, char> && !std::is_same_v<T, bool>;
+
+	template<typename T>
+	static constexpr bool is_text = !is_number<T> && !std::is_same_v<T, char>;
+
+public:
+	template<size_t N>
+	consteval ScanFormat(const char (&s)[N]) : format(s, N - 1) {
+		constexpr bool text_fields[] = {is_text<Args>..., false};
+
+		size_t field = 0;
+		size_t start = 0;
+		size_t length = 0;
+		bool escaped = false;
+		for (size_t i = 0; i < format.size(); ++i) {
+			const char c = format[i];
+			if ((c == '{' || c == '}') && i + 1 < format.size() && format[i + 1] == c) {
+				++i;
+				++length;
+				escaped = true;
+			} else if (c == '{') {
+				if (i + 1 >= format.size() || format[i + 1] != '}') throw "ScanFormat: '{' must be followed by '}' or be escaped as '{{'";
+				if (field >= field_count) throw "ScanFormat: more {} than types";
+				literals[field] = Literal{start, i - start, length, escaped};
+				if (field > 0 && length == 0 && text_fields[field - 1]) throw "ScanFormat: text field must be followed by literal text";
+				++field;
+				++i;
+				start = i + 1;
+				length = 0;
+				escaped = false;
+			} else if (c == '}') {
+				throw "ScanFormat: unmatched '}' must be escaped as '}}'";
+			} else {
+				++length;
+			}
+		}
+		if (field != field_count) throw "ScanFormat: fewer {} than types";
+		literals[field] = Literal{start, format.size() - start, length, escaped};
+	}
+
+	const Literal& literal(size_t i) const { return literals[i]; }
+
+	/**
+	 * Checks whether literal i matches at p
+	 * @return end of the match or nullptr
+	 */
+	const char* match_literal(size_t i, const char* p, const char* end) const {
+		const auto& lit = literals[i];
+		if (static_cast<size_t>(end - p) < lit.length) return nullptr;
+		const char* raw = format.data() + lit.offset;
+		if (!lit.escaped) {
+			return std::memcmp(p, raw, lit.length) == 0 ? p + lit.length : nullptr;
+		}
+		for (size_t j = 0; j < lit.raw_length; ++j, ++p) {
+			if (*p != raw[j]) return nullptr;
+			if ((raw[j] == '{' || raw[j] == '}') && j + 1 < lit.raw_length && raw[j + 1] == raw[j]) ++j;
+		}
+		return p;
+	}
+
+	/**
+	 * First position at or after p where literal i matches
+	 * @return position or nullptr
+	 */
+	const char* find_literal(size_t i, const char* p, const char* end) const {
+		const auto& lit = literals[i];
+		if (!lit.escaped) {
+			const std::string_view haystack(p, end - p);
+			const auto idx = haystack.find(std::string_view(format.data() + lit.offset, lit.length));
+			return idx == std::string_view::npos ? nullptr : p + idx;
+		}
+		for (; p != end; ++p) {
+			if (match_literal(i, p, end) != nullptr) return p;
+		}
+		return nullptr;
+	}
+
+	/**
+	 * Parses field I starting at p and matches the literal behind it
+	 * @return position after the literal or nullptr
+	 */
+	template<size_t I, typename T>
+	const char* scan_field(const char* p, const char* end, T& value) const {
+		constexpr bool last = I + 1 == field_count;
+		const auto& next = literals[I + 1];
+
+		if constexpr (is_number<T>) {
+			if (p != end && *p == '+') ++p;
+			const auto [ptr, ec] = std::from_chars(p, end, value);
+			if (ec != std::errc()) return nullptr;
+			return match_literal(I + 1, ptr, end);
+		} else if constexpr (std::is_same_v<T, char>) {
+			if (p == end) return nullptr;
+			value = *p;
+			return match_literal(I + 1, p + 1, end);
+		} else {
+			const char* field_end;
+			if (last) {
+				if (static_cast<size_t>(end - p) < next.length) return nullptr;
+				field_end = end - next.length;
+			} else {
+				field_end = find_literal(I + 1, p, end);
+				if (field_end == nullptr) return nullptr;
+			}
+			const char* after = match_literal(I + 1, field_end, end);
+			if (after != nullptr) {
+				value = string_to_generic<T>(std::string_view(p, field_end - p));
+			}
+			return after;
+		}
+	}
+};
+
+/**
+ * Scans a string with a format string instead of a regex
+ * scan<std::string_view, int>("{} has {} apples", line)
+ * @tparam Args types of the fields
+ * @param format literal text with one {} per field
+ * @param s string to be scanned - must match the format completely
+ * @return parsed fields or std::nullopt if s does not match
+ */
+template<typename... Args>
+std::optional<std::tuple<Args...>> scan_opt(ScanFormat<std::type_identity_t<Args>...> format, std::string_view s) {
+	const char* end = s.data() + s.size();
+	const char* p = format.match_literal(0, s.data(), end);
+	if (p == nullptr) {
+		return std::nullopt;
+	}
+
+	std::tuple<Args...> result{};
+	const bool matched = [&]<size_t... I>(std::index_sequence<I...>) {
+		return (((p = format.template scan_field<I>(p, end, std::get<I>(result))) != nullptr) && ...);
+	}(std::index_sequence_for<Args...>{});
+
+	if (!matched || p != end) {
+		return std::nullopt;
+	}
+	return result;
+}
+
+/**
+ * Scans a string with a format string instead of a regex
+ * @throws 0xDEAD If s does not match the format
+ */
+template<typename... Args>
+std::tuple<Args...> scan(ScanFormat<std::type_identity_t<Args>...> format, std::string_view s) {
+	auto result = scan_opt<Args...>(format, s);
+	if (!result) {
+		Logger::critical("Failed to scan '{}'", s);
+	}
+	return *result;
+}
+
+/**
+ * Scans every non-empty line of the input with the same format and appends the results
+ * @param format literal text with one {} per field
+ * @param input lines to be scanned
+ * @param out receives one tuple per line
+ * @throws 0xDEAD If a line does not match the format
+ */
+template<typename... Args>
+void scan_lines(ScanFormat<std::type_identity_t<Args>...> format, std::string_view input, std::vector<std::tuple<Args...>>& out) {
+	for (auto line : split_lines_range(input)) {
+		if (line.empty()) continue;
+		out.push_back(scan<Args...>(format, line));
+	}
+}
+
+template<typename... Args>
+std::vector<std::tuple<Args...>> scan_lines(ScanFormat<std::type_identity_t<Args>...> format, std::string_view input) {
+	std::vector<std::tuple<Args...>> result{};
+	scan_lines<Args...>(format, input, result);
+	return result;
+}
+
 std::vector<std::string> split_regex(const std::string& s, std::regex& pattern);
 
 template<typename T>
@@ -408,6 +890,182 @@ bool isHex(char c);
 
 std::string format_time(std::chrono::duration<std::chrono::nanoseconds::rep, std::chrono::nanoseconds::period> duration);
 
+/**
+ * Formats a size as "512 B", "1.5 KiB", "12.0 MiB", ...
+ */
+std::string format_bytes(size_t bytes);
+
+/* ====================================================================================================
+ * Phase Timing
+ */
+struct PhaseTiming {
+	const char* name;
+	std::chrono::nanoseconds duration{0};
+	size_t count = 0;
+};
+
+/**
+ * Phase timings of the currently running solver call. nullptr if no one is collecting,
+ * in which case PHASE only costs a single branch.
+ */
+inline thread_local std::vector<PhaseTiming>* active_phases = nullptr;
+
+/**
+ * Adds the duration to the phase with the given name or appends a new phase
+ * @param phases phases to be updated
+ * @param name name of the phase - repeated phases with the same name are summed up
+ * @param duration time spent in the phase
+ * @param count number of times the phase was entered
+ */
+void record_phase(std::vector<PhaseTiming>& phases, const char* name, std::chrono::nanoseconds duration, size_t count = 1);
+
+/**
+ * Formats the phases as "name time (percent of total)" separated by " | "
+ * @param phases phases to be formatted
+ * @param total duration that the percentages refer to
+ * @param runs number of runs the phase durations were summed over
+ */
+std::string format_phases(const std::vector<PhaseTiming>& phases, std::chrono::nanoseconds total, size_t runs = 1);
+
+/**
+ * Times the enclosing scope (or until stop() is called) as a named phase of the running solver call.
+ * Usually used through PHASE("name").
+ */
+class ScopedPhase {
+private:
+	const char* name;
+	std::vector<PhaseTiming>* target;
+	std::chrono::high_resolution_clock::time_point start;
+
+public:
+	explicit ScopedPhase(const char* name) : name(name), target(active_phases) {
+		if (target != nullptr) {
+			start = std::chrono::high_resolution_clock::now();
+		}
+	}
+
+	ScopedPhase(const ScopedPhase&) = delete;
+	ScopedPhase& operator=(const ScopedPhase&) = delete;
+
+	~ScopedPhase() {
+		stop();
+	}
+
+	void stop() {
+		if (target == nullptr) return;
+		auto end = std::chrono::high_resolution_clock::now();
+		record_phase(*target, name, std::chrono::duration_cast<std::chrono::nanoseconds>(end - start));
+		target = nullptr;
+	}
+};
+
+#define PHASE_CONCAT_IMPL(a, b) a##b
+#define PHASE_CONCAT(a, b) PHASE_CONCAT_IMPL(a, b)
+#define PHASE(name) ScopedPhase PHASE_CONCAT(phase_, __LINE__)(name)
+
+/* ====================================================================================================
+ * Benchmarking
+ */
+struct TimingStats {
+	size_t samples = 0;
+	std::chrono::nanoseconds min{0};
+	std::chrono::nanoseconds median{0};
+	std::chrono::nanoseconds p90{0};
+	std::chrono::nanoseconds max{0};
+	std::chrono::nanoseconds mean{0};
+	std::chrono::nanoseconds stddev{0};
+};
+
+/**
+ * Computes min/median/p90/max, mean and (sample) standard deviation of the given durations
+ * @param samples measured durations - order does not matter
+ * @return statistics; all zero if samples is empty
+ */
+TimingStats compute_timing_stats(std::vector<std::chrono::nanoseconds> samples);
+
+/**
+ * Calls fn runs times and returns the statistics of the runs; shared by the bench_* functions
+ * @param prepare if given, called before every run outside of the timed section; fn gets its result
+ */
+template<typename Fn, typename Prepare = std::nullptr_t>
+TimingStats time_runs(unsigned runs, Fn&& fn, Prepare&& prepare = nullptr) {
+	std::vector<std::chrono::nanoseconds> samples{};
+	samples.reserve(runs);
+	for (unsigned run = 0; run < runs; ++run) {
+		if constexpr (std::is_null_pointer_v<std::remove_cvref_t<Prepare>>) {
+			auto start_time = std::chrono::high_resolution_clock::now();
+			fn();
+			auto end_time = std::chrono::high_resolution_clock::now();
+			samples.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(end_time - start_time));
+		} else {
+			auto state = prepare();
+			auto start_time = std::chrono::high_resolution_clock::now();
+			fn(state);
+			auto end_time = std::chrono::high_resolution_clock::now();
+			samples.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(end_time - start_time));
+		}
+	}
+	return compute_timing_stats(std::move(samples));
+}
+
+/**
+ * Items processed per second if processing them took duration (at least 1 ns)
+ */
+inline double per_second(size_t items, std::chrono::nanoseconds duration) {
+	return static_cast<double>(items) * 1e9 / static_cast<double>(std::max<int64_t>(duration.count(), 1));
+}
+
+constexpr double DEFAULT_REGRESSION_THRESHOLD = 10.0;
+
+struct RunnerOptions {
+	/** measured runs per input; 0 disables benchmark mode */
+	unsigned bench_runs = 0;
+	/** untimed runs per input before measuring */
+	unsigned bench_warmup = 0;
+	/** collect and print PHASE timings of inputs */
+	bool phases = true;
+	/** evaluate tests and inputs concurrently on a thread pool */
+	bool parallel = false;
+	/** worker threads in parallel mode; 0 uses the hardware concurrency */
+	unsigned threads = 0;
+	/** give every solver call its own RunArena (see run_memory()) and report its usage */
+	bool arena = true;
+	/** count heap allocations and sample the peak RSS of every input */
+	bool memory = false;
+	/** read hardware performance counters (perf_event_open) around the measured runs of every input */
+	bool perf = false;
+	/** append one record per test and input to this file; empty disables the report */
+	std::string report_path = "";
+	ReportFormat report_format = ReportFormat::JSON;
+	/** compare the median time of every input against this report; empty disables the comparison */
+	std::string baseline_path = "";
+	/** slowdown against the baseline in percent above which an input counts as regressed */
+	double regression_threshold = DEFAULT_REGRESSION_THRESHOLD;
+};
+
+constexpr unsigned DEFAULT_BENCH_RUNS = 10;
+constexpr unsigned DEFAULT_BENCH_WARMUP = 3;
+
+/**
+ * Parses command line flags for the Runner
+ *   --bench          enables benchmark mode with default repetitions
+ *   --runs=N         measured runs per input, at least 1 (implies --bench)
+ *   --warmup=N       warmup runs per input (implies --bench)
+ *   --no-phases      disables collecting PHASE timings
+ *   --parallel       runs tests and inputs concurrently
+ *   --threads=N      number of worker threads (implies --parallel)
+ *   --no-arena       run_memory() falls back to the heap
+ *   --memory         reports heap allocations and peak RSS per input
+ *   --perf           reports hardware performance counters per input (Linux)
+ *   --json=PATH      appends a JSON record per test and input to PATH (one object per line)
+ *   --csv=PATH       appends a CSV record per test and input to PATH
+ *   --baseline=PATH  compares the median time of every input against a report written earlier
+ *   --threshold=PCT  allowed slowdown against the baseline in percent (default 10)
+ * @param options options that are overwritten by the given flags
+ * @return updated options
+ */
+RunnerOptions parse_runner_options(int argc, char** argv, RunnerOptions options = {});
+
 template<typename Result, typename... Args>
 struct Test {
 	std::string input;
@@ -426,21 +1084,66 @@ struct Input {
 template <typename Result, typename... Args>
 class Runner {
 private:
-	typedef std::function<Result(std::string, Args...)> SolverFn;
+	typedef std::function<Result(const std::string&, Args...)> SolverFn;
+	typedef std::function<Result(std::string_view, Args...)> ViewSolverFn;
 	typedef std::function<std::string(Result)> ResultTransformFn;
 
-	SolverFn solve_fn;
+	SolverFn solve_fn = nullptr;
+	ViewSolverFn view_solve_fn = nullptr;
 	ResultTransformFn result_transform_fn = nullptr;
 
 	std::vector<Test<Result, Args...>> tests;
 	std::vector<Input<Args...>> inputs;
 	std::vector<Result> results;
 
-	unsigned tests_failed;
-	unsigned tests_succeeded;
+	std::atomic<unsigned> tests_failed = 0;
+	std::atomic<unsigned> tests_succeeded = 0;
+
+	int year;
+	int day;
+	int part;
+	/** one per reported test and input; only collected if a report or baseline is configured */
+	std::vector<ReportRecord> records;
+	unsigned regressions = 0;
+
+	RunnerOptions options;
+	std::unique_ptr<ThreadPool> pool = nullptr;
+
+	/**
+	 * Measured outcome of one input. Produced on any thread, logged on the calling thread.
+	 */
+	struct InputRun {
+		Result result;
+		/** duration of the run; sum of the measured runs in benchmark mode */
+		std::chrono::nanoseconds duration{0};
+		std::vector<PhaseTiming> phases{};
+		/** only set in benchmark mode */
+		std::optional<TimingStats> stats{};
+		bool unstable = false;
+		/** arena usage of the (first measured) run; only with options.arena */
+		std::optional<ArenaStats> arena{};
+		/** heap and RSS of the (first measured) run; only with options.memory */
+		std::optional<MemoryStats> memory{};
+		/** hardware counters per measured run; only with options.perf */
+		std::optional<PerfStats> perf{};
+	};
 
 public:
-	Runner(SolverFn solve_fn, const int year, const int day) : solve_fn(solve_fn), tests_failed(0), tests_succeeded(0) {
+	/**
+	 * @param solve_fn solver taking the input as std::string_view (zero-copy) or as std::string
+	 * @param year
+	 * @param day
+	 * @param part only used to identify the records of the report; 0 if unknown
+	 */
+	template<typename Fn> requires (std::is_invocable_r_v<Result, Fn&, std::string_view, Args...>
+		|| std::is_invocable_r_v<Result, Fn&, const std::string&, Args...>)
+	Runner(Fn solve_fn, const int year, const int day, const int part = 0) : year(year), day(day), part(part) {
+		if constexpr (std::is_invocable_r_v<Result, Fn&, std::string_view, Args...>) {
+			view_solve_fn = solve_fn;
+		} else {
+			this->solve_fn = solve_fn;
+		}
+
 		Logger::init();
 		Logger::info("==================================================");
 		Logger::info("=========== Advent of Code {} Day {} ===========", year, pad_left(std::to_string(day), 2, '0'));
@@ -451,6 +1154,34 @@ public:
 		this->result_transform_fn = result_transform_fn;
 	}
 
+	/**
+	 * Runs every input warmup + runs times and reports timing statistics over the measured runs.
+	 * @param runs number of measured runs; at least 1
+	 * @param warmup number of untimed runs before measuring
+	 */
+	void set_benchmark(unsigned runs, unsigned warmup = DEFAULT_BENCH_WARMUP) {
+		if (runs == 0) {
+			Logger::critical("Benchmark mode needs at least one measured run (set_benchmark(0))");
+		}
+		options.bench_runs = runs;
+		options.bench_warmup = warmup;
+	}
+
+	/**
+	 * Evaluates tests and inputs concurrently. Results are still logged in the order they were added.
+	 * In benchmark mode inputs keep running one after another so the measurements do not interfere.
+	 * @param parallel enables parallel mode
+	 * @param threads number of worker threads; 0 uses the hardware concurrency
+	 */
+	void set_parallel(bool parallel, unsigned threads = 0) {
+		options.parallel = parallel;
+		options.threads = threads;
+	}
+
+	void parse_args(int argc, char** argv) {
+		options = parse_runner_options(argc, argv, options);
+	}
+
 	void add_test_string(const std::string& input, Result expected, Args... args) {
 		tests.push_back(Test<Result, Args...>(input, expected, false, {args...}));
 	}
@@ -468,25 +1199,7 @@ public:
 	}
 
 	bool run_test(const Test<Result, Args...>& test) {
-		auto input = test.input;
-		if (test.file) {
-			input = read_file(input);
-		}
-		Result result = std::apply(
-			[=](auto&&... args) -> Result {
-				return solve_fn(input, args...);
-			},
-			test.args
-		);
-
-		if (result == test.expected) {
-			tests_succeeded++;
-			return true;
-		}
-
-		Logger::error("Failed Test '{}': Expected {} but got {}", test.input, test.expected, result);
-		tests_failed++;
-		return false;
+		return report_test(test, evaluate_test(test));
 	}
 
 	bool run_tests() {
@@ -499,19 +1212,25 @@ public:
 		tests_failed = 0;
 		tests_succeeded = 0;
 
-		for (auto& test : tests) {
-			run_test(test);
+		if (options.parallel) {
+			run_ordered(thread_pool(), tests.size(),
+				[&](size_t i) { return evaluate_test(tests[i]); },
+				[&](size_t i, const InputRun& run) { report_test(tests[i], run); });
+		} else {
+			for (auto& test : tests) {
+				run_test(test);
+			}
 		}
 
 		Logger::info("==================================================");
 		Logger::info("Test(s) Finished");
 		Logger::info("--------------------------------------------------");
 		if (tests_succeeded != 0) {
-			Logger::info("Succeded: {}", tests_succeeded);
+			Logger::info("Succeded: {}", tests_succeeded.load());
 		}
 
 		if (tests_failed != 0) {
-			Logger::error("Failed: {}", tests_failed);
+			Logger::error("Failed: {}", tests_failed.load());
 		}
 		Logger::info("==================================================");
 
@@ -519,32 +1238,331 @@ public:
 	}
 
 	Result run_input(const Input<Args...>& input) {
-		auto input_str = input.input;
-		if (input.file) {
-			input_str = read_file(input_str);
+		auto run = measure_input(input);
+		report_input(input, run);
+		return run.result;
+	}
+
+	/**
+	 * Runs the solver on an already loaded input bench_warmup + bench_runs times
+	 * and logs the statistics of the measured runs
+	 */
+	Result bench_input(const Input<Args...>& input, const InputBuffer& input_str) {
+		auto run = measure_bench(input, input_str);
+		report_input(input, run);
+		return run.result;
+	}
+
+private:
+	ThreadPool& thread_pool() {
+		if (pool == nullptr) {
+			pool = std::make_unique<ThreadPool>(options.threads);
+			Logger::info("Running in parallel on {} thread(s)", pool->size());
 		}
-		auto start_time = std::chrono::high_resolution_clock::now();
-		Result result = std::apply(
-			[=](auto&&... args) -> Result {
-				return solve_fn(input_str, args...);
+		return *pool;
+	}
+
+	/**
+	 * Maps or copies the input once. Solvers taking a std::string get their copy here,
+	 * outside of the timed section.
+	 */
+	InputBuffer load_input(const std::string& input, bool file) const {
+		auto buffer = file ? read_input(input) : InputBuffer(input);
+		if (view_solve_fn == nullptr) {
+			buffer.str();
+		}
+		return buffer;
+	}
+
+	Result call_solver(const InputBuffer& input, const std::tuple<Args...>& args, HeapStats* heap_stats) {
+		if (heap_stats != nullptr) {
+			HeapTracker tracker;
+			Result result = call_solver(input, args, nullptr);
+			*heap_stats = tracker.stats();
+			return result;
+		}
+
+		return std::apply(
+			[&](auto&&... args) -> Result {
+				if (view_solve_fn != nullptr) {
+					return view_solve_fn(input.view(), args...);
+				}
+				return solve_fn(input.str(), args...);
 			},
-			input.args
+			args
 		);
+	}
+
+	/**
+	 * Calls the solver with its own RunArena installed, which is released as a whole afterwards.
+	 * The result must not point into memory allocated from run_memory().
+	 * Setting up and releasing the arena and reading and resetting the peak RSS happen outside of the
+	 * timed section, the performance counters only enclose it
+	 */
+	Result solve_timed(const InputBuffer& input, const std::tuple<Args...>& args, std::chrono::nanoseconds& duration,
+		std::vector<PhaseTiming>* phases = nullptr, ArenaStats* arena_stats = nullptr, MemoryStats* memory = nullptr,
+		PerfCounters* perf = nullptr) {
+		std::optional<RunArena> arena{};
+		if (options.arena) {
+			arena.emplace();
+		}
+		ScopedArena scope(arena ? &*arena : active_arena);
+		if (memory != nullptr) {
+			memory->rss_reset = reset_peak_rss();
+		}
+		auto* previous_phases = active_phases;
+		active_phases = phases;
+		if (perf != nullptr) {
+			perf->start();
+		}
+		auto start_time = std::chrono::high_resolution_clock::now();
+		Result result = call_solver(input, args, memory != nullptr ? &memory->heap : nullptr);
 		auto end_time = std::chrono::high_resolution_clock::now();
-		auto duration =
-			std::chrono::duration_cast<std::chrono::nanoseconds>(end_time - start_time);
+		if (perf != nullptr) {
+			perf->stop();
+		}
+		active_phases = previous_phases;
+		if (memory != nullptr) {
+			memory->peak_rss = peak_rss();
+		}
+		if (arena && arena_stats != nullptr) {
+			*arena_stats = arena->stats();
+		}
+		duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end_time - start_time);
+		return result;
+	}
 
+	std::string format_result(const Result& result) const {
 		if (result_transform_fn == nullptr) {
-			Logger::info("Input Finished '{}': {} ({})", input.input, result, format_time(duration));
+			return fmt::format("{}", result);
+		}
+		return result_transform_fn(result);
+	}
+
+	/**
+	 * Solves a test without logging; safe to call from worker threads
+	 */
+	InputRun evaluate_test(const Test<Result, Args...>& test) {
+		auto input = load_input(test.input, test.file);
+		std::chrono::nanoseconds duration;
+		Result result = solve_timed(input, test.args, duration);
+		return InputRun{std::move(result), duration};
+	}
+
+	bool report_test(const Test<Result, Args...>& test, const InputRun& run) {
+		const bool passed = run.result == test.expected;
+		if (collect_records()) {
+			auto record = make_record("test", test.input, run);
+			record.expected = format_result(test.expected);
+			record.passed = passed;
+			records.push_back(std::move(record));
+		}
+
+		if (passed) {
+			tests_succeeded++;
+			return true;
+		}
+
+		Logger::error("Failed Test '{}': Expected {} but got {}", test.input, test.expected, run.result);
+		tests_failed++;
+		return false;
+	}
+
+	/**
+	 * Solves (or benchmarks) an input without logging; safe to call from worker threads
+	 */
+	InputRun measure_input(const Input<Args...>& input) {
+		auto input_str = load_input(input.input, input.file);
+
+		if (options.bench_runs > 0) {
+			return measure_bench(input, input_str);
+		}
+
+		std::chrono::nanoseconds duration;
+		std::vector<PhaseTiming> phases;
+		std::optional<ArenaStats> arena = options.arena ? std::optional<ArenaStats>(ArenaStats{}) : std::nullopt;
+		std::optional<MemoryStats> memory = options.memory ? std::optional<MemoryStats>(MemoryStats{}) : std::nullopt;
+		auto perf = options.perf ? std::make_unique<PerfCounters>() : nullptr;
+		Result result = solve_timed(input_str, input.args, duration, options.phases ? &phases : nullptr,
+			arena ? &*arena : nullptr, memory ? &*memory : nullptr, perf.get());
+		return InputRun{std::move(result), duration, std::move(phases), std::nullopt, false, arena, memory,
+			perf_stats(perf.get())};
+	}
+
+	InputRun measure_bench(const Input<Args...>& input, const InputBuffer& input_str) {
+		std::chrono::nanoseconds duration;
+		for (unsigned i = 0; i < options.bench_warmup; ++i) {
+			solve_timed(input_str, input.args, duration);
+		}
+
+		std::vector<std::chrono::nanoseconds> samples;
+		samples.reserve(options.bench_runs);
+
+		std::vector<PhaseTiming> phases;
+		auto* phases_target = options.phases ? &phases : nullptr;
+		std::optional<ArenaStats> arena = options.arena ? std::optional<ArenaStats>(ArenaStats{}) : std::nullopt;
+		std::optional<MemoryStats> memory = options.memory ? std::optional<MemoryStats>(MemoryStats{}) : std::nullopt;
+		auto perf = options.perf ? std::make_unique<PerfCounters>() : nullptr;
+		Result result = solve_timed(input_str, input.args, duration, phases_target, arena ? &*arena : nullptr,
+			memory ? &*memory : nullptr, perf.get());
+		samples.push_back(duration);
+
+		bool unstable = false;
+		for (unsigned i = 1; i < options.bench_runs; ++i) {
+			Result repeated = solve_timed(input_str, input.args, duration, phases_target, nullptr, nullptr, perf.get());
+			samples.push_back(duration);
+			unstable |= !(repeated == result);
+		}
+
+		auto total = std::accumulate(samples.begin(), samples.end(), std::chrono::nanoseconds(0));
+		return InputRun{std::move(result), total, std::move(phases), compute_timing_stats(samples), unstable, arena, memory,
+			perf_stats(perf.get())};
+	}
+
+	void report_input(const Input<Args...>& input, const InputRun& run) {
+		if (collect_records()) {
+			records.push_back(make_record("input", input.input, run));
+		}
+
+		if (!run.stats.has_value()) {
+			Logger::info("Input Finished '{}': {} ({}{})", input.input, format_result(run.result), format_time(run.duration),
+				format_memory(run));
+			if (!run.phases.empty()) {
+				Logger::info("    {}", format_phases(run.phases, run.duration));
+			}
+			report_memory(run);
+			report_perf(run);
+			return;
+		}
+
+		const auto& stats = *run.stats;
+		Logger::info("Input Finished '{}': {} (median {}, {} runs, {} warmup{})",
+			input.input, format_result(run.result), format_time(stats.median), stats.samples, options.bench_warmup,
+			format_memory(run));
+		Logger::info("    min {} | median {} | p90 {} | max {} | stddev {}",
+			format_time(stats.min), format_time(stats.median), format_time(stats.p90),
+			format_time(stats.max), format_time(stats.stddev));
+		if (!run.phases.empty()) {
+			Logger::info("    {}", format_phases(run.phases, run.duration, stats.samples));
+		}
+		report_memory(run);
+		report_perf(run);
+		if (run.unstable) {
+			Logger::warn("    Result changed between runs - does the solver keep global state?");
+		}
+	}
+
+	void report_memory(const InputRun& run) const {
+		// solvers that never use run_memory() stay quiet
+		if (run.arena.has_value() && run.arena->allocations > 0) {
+			Logger::info("    arena: {}", format_arena_stats(*run.arena));
+		}
+	}
+
+	void report_perf(const InputRun& run) const {
+		if (run.perf.has_value()) {
+			if (run.perf->error.empty()) {
+				Logger::info("    perf: {}", format_perf_stats(*run.perf));
+			} else {
+				Logger::warn("    perf: {}", format_perf_stats(*run.perf));
+			}
+		}
+	}
+
+	static std::optional<PerfStats> perf_stats(const PerfCounters* perf) {
+		return perf != nullptr ? std::optional<PerfStats>(perf->stats()) : std::nullopt;
+	}
+
+	bool collect_records() const {
+		return !options.report_path.empty() || !options.baseline_path.empty();
+	}
+
+	ReportRecord make_record(const char* kind, const std::string& input, const InputRun& run) const {
+		ReportRecord record{year, day, part, kind, input, format_result(run.result)};
+		const auto stats = run.stats.value_or(TimingStats{1, run.duration, run.duration, run.duration, run.duration, run.duration});
+		record.runs = stats.samples;
+		record.warmup = run.stats.has_value() ? options.bench_warmup : 0;
+		record.min = stats.min;
+		record.median = stats.median;
+		record.p90 = stats.p90;
+		record.max = stats.max;
+		record.mean = stats.mean;
+		record.stddev = stats.stddev;
+		record.unstable = run.unstable;
+		record.arena = run.arena;
+		record.memory = run.memory;
+		record.perf = run.perf;
+		return record;
+	}
+
+	/**
+	 * Compares the inputs against the baseline before the report is written, so both may be the same file
+	 */
+	void finish_report() {
+		if (!options.baseline_path.empty()) {
+			check_baseline();
+		}
+		if (!options.report_path.empty()) {
+			write_report(options.report_path, options.report_format, records);
+			Logger::info("Wrote {} record(s) to '{}'", records.size(), options.report_path);
+		}
+		records.clear();
+	}
+
+	void check_baseline() {
+		auto baseline = read_baseline(options.baseline_path);
+		auto comparisons = compare_to_baseline(records, baseline, options.regression_threshold);
+
+		Logger::info("==================================================");
+		Logger::info("Comparing against Baseline '{}' (threshold {}%)", options.baseline_path, options.regression_threshold);
+		Logger::info("==================================================");
+
+		regressions = 0;
+		for (const auto& comparison : comparisons) {
+			const auto& record = *comparison.record;
+			if (!comparison.baseline.has_value()) {
+				Logger::warn("Not in Baseline '{}': median {}", record.input, format_time(record.median));
+			} else if (comparison.regressed) {
+				Logger::error("Regression '{}': median {} -> {} ({:+.1f}%)", record.input,
+					format_time(*comparison.baseline), format_time(record.median), comparison.change * 100.0);
+				regressions++;
+			} else {
+				Logger::info("'{}': median {} -> {} ({:+.1f}%)", record.input,
+					format_time(*comparison.baseline), format_time(record.median), comparison.change * 100.0);
+			}
+		}
+
+		Logger::info("--------------------------------------------------");
+		if (regressions != 0) {
+			Logger::error("Regressed: {}", regressions);
 		} else {
-			Logger::info("Input Finished '{}': {} ({})", input.input, result_transform_fn(result), format_time(duration));
+			Logger::info("No Regressions");
 		}
+		Logger::info("==================================================");
+	}
 
-		return result;
+	static std::string format_memory(const InputRun& run) {
+		return run.memory.has_value() ? ", " + format_memory_stats(*run.memory) : "";
 	}
 
+public:
 	std::vector<Result> run_inputs() {
 		results.clear();
+
+		// concurrent benchmark runs would compete for cores and caches
+		if (options.parallel && options.bench_runs == 0) {
+			run_ordered(thread_pool(), inputs.size(),
+				[&](size_t i) { return measure_input(inputs[i]); },
+				[&](size_t i, const InputRun& run) {
+					report_input(inputs[i], run);
+					results.push_back(run.result);
+				});
+			return results;
+		}
+
+		if (options.parallel && inputs.size() > 1) {
+			Logger::info("Benchmark mode: running inputs sequentially");
+		}
 		for (auto& input : inputs) {
 			results.emplace_back(run_input(input));
 		}
@@ -552,12 +1570,26 @@ public:
 	}
 
 	std::vector<Result> run() {
-		if (!run_tests()) return {};
-		run_inputs();
+		const bool tests_passed = run_tests();
+		if (tests_passed) {
+			run_inputs();
+		}
+		release_retained_arena();
+		finish_report();
+		if (!tests_passed) {
+			return {};
+		}
 
 		Logger::info("");
 		return results;
 	}
+
+	/**
+	 * Exit code for main: 1 if a test failed or an input regressed against the baseline, otherwise 0
+	 */
+	int exit_code() const {
+		return tests_failed != 0 || regressions != 0 ? 1 : 0;
+	}
 };
 
 std::vector<size_t> find_all_idx(const std::string& s, const std::string& pattern);
@@ -802,14 +1834,20 @@ Vec2i arrow_dir(char c);
 template<typename T, typename U>
 struct std::hash<std::pair<T, U>> {
 	size_t operator()(const std::pair<T, U>& pair) const noexcept {
-		return std::hash<T>()(pair.first) ^ std::hash<U>()(pair.second);
+		if constexpr (std::is_integral_v<T> && std::is_integral_v<U> && sizeof(T) <= 4 && sizeof(U) <= 4) {
+			return hash_pair32(static_cast<uint32_t>(pair.first), static_cast<uint32_t>(pair.second));
+		} else {
+			return hash_combine(std::hash<T>()(pair.first), std::hash<U>()(pair.second));
+		}
 	}
 };
 
 template<typename... Ts>
 struct std::hash<std::tuple<Ts...>> {
 	size_t operator()(const std::tuple<Ts...>& tuple) const noexcept {
-		return std::apply([](const auto& ... xs){ return (std::hash<Ts>()(xs) ^ ...); }, tuple);
+		size_t hash = 0;
+		std::apply([&](const auto& ... xs){ ((hash = hash_combine(hash, std::hash<Ts>()(xs))), ...); }, tuple);
+		return hash;
 	}
 };
 